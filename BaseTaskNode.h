@@ -26,46 +26,91 @@
 #pragma once
 
 #include <vector>
-#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <cstdint>
 
 namespace BabyTask {
 
+    // 'no successor' branch index of a condition node
+    inline constexpr std::size_t NoBranch{ ~std::size_t{} };
+
+    class TaskGraph;
+
     /**
     * \brief task graph node interface
     **/
     class BaseTaskNode {
+        // friends
+        friend class TaskGraph;
+
         public:
 
-            BaseTaskNode(const char* name) noexcept : mName(name) {}
+            /**
+            * \brief constructor
+            *
+            * @param {TaskGraph*,      in} graph
+            * @param {string_view,     in} node name
+            * @param {memory_resource, in} graph arena
+            **/
+            BaseTaskNode(TaskGraph* xi_graph, std::string_view xi_name, std::pmr::memory_resource* xi_resource) noexcept : mDescendants(xi_resource), mGraph(xi_graph), mName(xi_name) {}
             virtual ~BaseTaskNode() noexcept = default;
 
             /**
             * \brief execute node task
+            *
+            * @param {bool, out} false if node task continues elsewhere (the node is completed later by its graph)
             **/
-            virtual void execute() = 0;
+            virtual bool execute() = 0;
 
             /**
-            * \brief return number of pending tasks
+            * \brief declare node's parent (where parent output is not current node input's)
+            *        (defined in TaskGraph.h, where TaskGraph is a complete type)
+            *
+            * @param {BaseTaskNode, in} current node parent
             **/
-            virtual std::size_t getPendingCount() const = 0;
+            void setParent(BaseTaskNode& xi_parent);
+
+            /**
+            * \brief return number of pending tasks (defined in TaskGraph.h)
+            **/
+            std::size_t getPendingCount() const;
 
             /**
             * \brief return task name
             *
-            * @param {string, out} node name
+            * @param {string_view, out} node name (held by the graph)
             **/
-            const std::string& getName() const { return mName; }
+            std::string_view getName() const { return mName; }
 
             /**
             * \brief reset node
             **/
             virtual void reset() = 0;
 
-            // descendant nodes (will be executed once this node has finished)
-            std::vector<BaseTaskNode*> mDescendants;
+            /**
+            * \brief deliver the result kept from last execution to connected descendant arguments again
+            *        (so descendants can be executed without executing this node)
+            *
+            * @param {bool, out} false if node has connected descendants but no kept result
+            **/
+            virtual bool redeliver() { return true; }
+
+            // descendant nodes (will be executed once this node has finished), allocated in graph arena
+            std::pmr::vector<BaseTaskNode*> mDescendants;
 
         // internals
         protected:
-            std::string mName;
+            TaskGraph* mGraph;              // pointer to task graph
+            std::string_view mName;         // node name (interned by graph)
+            std::uint32_t mIndex{};         // node index in its graph
+            std::uint32_t mParentCount{};   // how many parents (and arguments) this node has
+            float mCost{ -1.0f };           // user supplied execution cost (in microseconds, negative if unknown)
+            float mMeasuredCost{ -1.0f };   // measured execution cost (in microseconds, negative if not measured yet)
+            std::size_t mLocality{ ~std::size_t{} }; // NUMA node this node prefers to run on (AnyNode if none)
+            std::size_t mBranch{ NoBranch };         // successor chosen by last execution (condition nodes only)
+            bool mCondition{ false };                // true if only one successor (the chosen branch) runs after this node
+            bool mKeepResult{ false };               // true if result is kept after being delivered (incremental execution)
+            bool mDirty{ true };                     // true if node must run on next incremental execution (never executed nodes are dirty)
     };
 };
\ No newline at end of file
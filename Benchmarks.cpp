@@ -0,0 +1,650 @@
+/**
+* BabyTask - minimalistic and generic graph based task library
+*
+* Dan Israel Malta
+**/
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
+#include "TaskGraph.h"
+#include "StaticTaskGraph.h"
+
+// for benchmark purposes
+#include <chrono>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <utility>
+#include <random>
+#include <cmath>
+#include <limits>
+
+// return elapsed time (in seconds) of a given callable
+template<typename F>
+double Measure(F&& xi_task) {
+    const auto start = std::chrono::steady_clock::now();
+    xi_task();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// queue contention: 'producers' threads push 'count' elements (in total, 'batch' elements at a time)
+// while 'consumers' threads pop them. return throughput in millions of elements per second.
+template<typename QueueType>
+double QueueContention(std::size_t producers, std::size_t consumers, std::size_t count, std::size_t batch) {
+    QueueType queue;
+    std::atomic<std::size_t> popped{};
+    std::atomic<bool> go{ false };
+    std::vector<std::thread> threads;
+
+    const std::size_t perProducer{ count / producers };
+    const std::size_t total{ perProducer * producers };
+
+    for (std::size_t p{}; p < producers; ++p) {
+        threads.emplace_back([&queue, &go, perProducer, batch]() {
+            std::vector<std::size_t> elements(batch);
+            while (!go) std::this_thread::yield();
+
+            for (std::size_t i{}; i < perProducer; i += batch) {
+                const std::size_t len{ std::min(batch, perProducer - i) };
+                for (std::size_t j{}; j < len; ++j) {
+                    elements[j] = i + j;
+                }
+
+                std::size_t pushed{};
+                while (pushed < len) {
+                    const std::size_t n{ (len == 1) ? static_cast<std::size_t>(queue.push(elements[0])) :
+                                                      queue.push_bulk(elements.data() + pushed, len - pushed) };
+                    if (n == 0) std::this_thread::yield();
+                    pushed += n;
+                }
+            }
+        });
+    }
+
+    for (std::size_t c{}; c < consumers; ++c) {
+        threads.emplace_back([&queue, &go, &popped, total, batch]() {
+            std::vector<std::size_t> elements(batch);
+            while (!go) std::this_thread::yield();
+
+            while (popped < total) {
+                const std::size_t n{ (batch == 1) ? static_cast<std::size_t>(queue.pop(elements[0])) :
+                                                    queue.pop_bulk(elements.data(), batch) };
+                if (n == 0) std::this_thread::yield();
+                popped += n;
+            }
+        });
+    }
+
+    const double seconds{ Measure([&]() {
+        go = true;
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }) };
+
+    return static_cast<double>(total) / seconds * 1e-6;
+}
+
+// compare mutex protected queue and lock free bounded queue at 1-64 producers and consumers
+void QueueBenchmark(std::size_t xi_count) {
+    std::printf("queue contention (%zu elements, Melements/sec)\n", xi_count);
+    std::printf("%10s %10s %8s %12s %12s\n", "producers", "consumers", "batch", "Queue", "BoundedQueue");
+
+    for (std::size_t threads{ 1 }; threads <= 64; threads *= 2) {
+        for (std::size_t batch : { std::size_t{ 1 }, std::size_t{ 32 } }) {
+            const double locked{ QueueContention<BabyTask::Queue<std::size_t>>(threads, threads, xi_count, batch) };
+            const double lockFree{ QueueContention<BabyTask::BoundedQueue<std::size_t>>(threads, threads, xi_count, batch) };
+            std::printf("%10zu %10zu %8zu %12.2f %12.2f\n", threads, threads, batch, locked, lockFree);
+        }
+    }
+}
+
+// chain of 'N' nodes: Edges<Edge<0, 1>, Edge<1, 2>, ..., Edge<N - 2, N - 1>>
+template<std::size_t... I>
+BabyTask::Edges<BabyTask::Edge<I, I + 1>...> ChainEdges(std::index_sequence<I...>);
+
+template<typename Task, std::size_t... I>
+auto MakeStaticChain(std::shared_ptr<BabyTask::Executor> xi_executor, Task xi_task, std::index_sequence<I...>) {
+    using EdgeList = decltype(ChainEdges(std::make_index_sequence<sizeof...(I) - 1>{}));
+    return BabyTask::makeStaticTaskGraph<EdgeList>(std::move(xi_executor), ((void)I, xi_task)...);
+}
+
+// execute a dynamic graph chain of 'nodes' trivial nodes 'runs' times, return elapsed time (in seconds)
+template<typename Task>
+double DynamicChain(std::shared_ptr<BabyTask::Executor> xi_executor, Task xi_task, std::size_t xi_nodes, std::size_t xi_runs) {
+    BabyTask::TaskGraph task_graph(std::move(xi_executor));
+    auto previous = task_graph.makeTaskNode(xi_task);
+    for (std::size_t i{ 1 }; i < xi_nodes; ++i) {
+        auto current = task_graph.makeTaskNode(xi_task);
+        current->setParent(*previous);
+        previous = current;
+    }
+
+    task_graph.execute();
+    return Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); });
+}
+
+// execute a static graph chain of 'Nodes' trivial nodes 'runs' times (on executor or sequentially), return elapsed time (in seconds)
+template<std::size_t Nodes, typename Task>
+double StaticChain(std::shared_ptr<BabyTask::Executor> xi_executor, Task xi_task, std::size_t xi_runs, bool xi_sequential) {
+    auto task_graph = MakeStaticChain(std::move(xi_executor), xi_task, std::make_index_sequence<Nodes>{});
+    if (xi_sequential) {
+        return Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.executeSequential(); });
+    }
+
+    task_graph.execute();
+    return Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); });
+}
+
+// per node overhead of a chain of trivial nodes, dynamic graph (type erased nodes, runtime topology) against
+// static graph (compile time topology). per execution cost (submitting sources and waking up the waiting thread)
+// is measured with a single node graph and subtracted.
+void GraphBenchmark(std::size_t xi_count) {
+    constexpr std::size_t nodes{ 128 };
+    const std::size_t runs{ std::max<std::size_t>(1, xi_count / nodes) };
+    std::printf("\ngraph overhead (chain of %zu nodes, %zu executions, 1 thread)\n", nodes, runs);
+    std::printf("%26s %16s %16s\n", "", "nsec/execution", "nsec/node");
+
+    std::atomic<std::size_t> counter{};
+    auto task = [&counter]() { counter.fetch_add(1, std::memory_order_relaxed); };
+    auto executor = std::make_shared<BabyTask::Executor>(1);
+
+    auto report = [runs](const char* name, double single, double chain) {
+        std::printf("%26s %16.2f %16.2f\n", name, single * 1e9 / static_cast<double>(runs),
+                    std::max(0.0, chain - single) * 1e9 / static_cast<double>(runs * (nodes - 1)));
+    };
+
+    report("TaskGraph", DynamicChain(executor, task, 1, runs), DynamicChain(executor, task, nodes, runs));
+    report("StaticTaskGraph", StaticChain<1>(executor, task, runs, false), StaticChain<nodes>(executor, task, runs, false));
+    report("StaticTaskGraph (serial)", StaticChain<1>(executor, task, runs, true), StaticChain<nodes>(executor, task, runs, true));
+}
+
+// busy wait for a given duration (simulated work)
+void Spin(std::chrono::microseconds xi_duration) {
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < xi_duration) {}
+}
+
+// makespan of an asymmetric graph (a chain of 16 x 100usec nodes next to 64 independent 50usec side nodes, which are
+// declared first) on 4 threads, with FIFO dispatch against critical path priority dispatch (costs measured by a first execution)
+void PriorityBenchmark(std::size_t xi_runs) {
+    std::printf("\ncritical path scheduling (chain of 16 x 100usec + 64 x 50usec side nodes, 4 threads, msec/execution)\n");
+    auto executor = std::make_shared<BabyTask::Executor>(4);
+
+    for (bool priority : { false, true }) {
+        BabyTask::TaskGraph task_graph(executor);
+        task_graph.setPriorityScheduling(priority);
+
+        for (std::size_t i{}; i < 64; ++i) {
+            task_graph.makeTaskNode([]() { Spin(std::chrono::microseconds(50)); });
+        }
+
+        BabyTask::BaseTaskNode* previous{ nullptr };
+        for (std::size_t i{}; i < 16; ++i) {
+            auto link = task_graph.makeTaskNode([]() { Spin(std::chrono::microseconds(100)); });
+            if (previous) {
+                link->setParent(*previous);
+            }
+            previous = link;
+        }
+
+        task_graph.execute();
+        const double seconds{ Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); }) };
+        std::printf("%24s %10.3f\n", priority ? "critical path" : "FIFO", seconds * 1e3 / static_cast<double>(xi_runs));
+    }
+}
+
+// cost of tracing a node (two timestamps and a ring buffer store, the ready time is the finish time of its parent),
+// i.e. - the overhead a node pays when compiled with BABYTASK_TRACING
+void TraceBenchmark(std::size_t xi_count) {
+    BabyTask::Tracer& tracer = BabyTask::Tracer::instance();
+    const std::string_view name{ tracer.intern("node") };
+    std::uint64_t ready{ BabyTask::Tracer::now() };
+
+    const double seconds{ Measure([&]() {
+        for (std::size_t i{}; i < xi_count; ++i) {
+            const std::uint64_t start{ BabyTask::Tracer::now() };
+            const std::uint64_t end{ BabyTask::Tracer::now() };
+            tracer.record(BabyTask::TraceEvent{ name, ready, start, end, 0 });
+            ready = end;
+        }
+    }) };
+    tracer.clear();
+
+    const double node{ seconds * 1e9 / static_cast<double>(xi_count) };
+    std::printf("\ntracing (%zu nodes)\n%24s %10.2f\n%24s %10.2f\n", xi_count, "nsec/node", node, "nsec/event", node / 3.0);
+}
+
+//
+// scheduler suite - standard DAG shapes at configurable node and thread counts
+//
+
+// return steady clock timestamp (in nanoseconds)
+std::int64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// a DAG shape: parents of every node (a node only depends on nodes declared before it)
+struct Shape {
+    std::string mName;
+    std::vector<std::vector<std::uint32_t>> mParents;
+};
+
+/**
+* \brief make a DAG shape
+*
+* @param {string, in}  shape name - empty (independent empty tasks), chain (linear chain), fan (1 -> n - 2 -> 1),
+*                      tree (binary out tree) or layered (sqrt(n) wide layers, up to 3 random parents in previous layer)
+* @param {size_t, in}  amount of nodes
+* @param {Shape,  out} shape
+**/
+Shape MakeShape(const std::string& xi_name, std::size_t xi_nodes) {
+    Shape shape{ xi_name, std::vector<std::vector<std::uint32_t>>(xi_nodes) };
+    std::mt19937 random(42);
+
+    const std::size_t width{ std::max<std::size_t>(1, static_cast<std::size_t>(std::sqrt(static_cast<double>(xi_nodes)))) };
+    for (std::uint32_t i{ 1 }; i < xi_nodes; ++i) {
+        auto& parents = shape.mParents[i];
+        if (xi_name == "chain") {
+            parents.push_back(i - 1);
+        }
+        else if (xi_name == "fan") {
+            if (i + 1 < xi_nodes) {
+                parents.push_back(0);
+            }
+            else {
+                for (std::uint32_t j{ 1 }; j < i; ++j) parents.push_back(j);
+            }
+        }
+        else if (xi_name == "tree") {
+            parents.push_back((i - 1) / 2);
+        }
+        else if ((xi_name == "layered") && (i >= width)) {
+            const std::uint32_t first{ static_cast<std::uint32_t>((i / width - 1) * width) };
+            std::uniform_int_distribution<std::uint32_t> pick(first, first + static_cast<std::uint32_t>(width) - 1);
+            for (std::size_t j{}; j < 3; ++j) {
+                const std::uint32_t parent{ pick(random) };
+                if (std::find(parents.begin(), parents.end(), parent) == parents.end()) parents.push_back(parent);
+            }
+        }
+    }
+
+    return shape;
+}
+
+// shape measurements
+struct ShapeResult {
+    double mTasksPerSecond;     // throughput
+    double mP50, mP90, mP99;    // node latency percentiles (nanoseconds from the moment a node became ready until it started)
+};
+
+/**
+* \brief execute a shape graph 'runs' times on a given amount of threads
+*
+* @param {Shape,       in}  shape
+* @param {size_t,      in}  amount of threads
+* @param {size_t,      in}  amount of executions
+* @param {ShapeResult, out} measurements
+**/
+ShapeResult RunShape(const Shape& xi_shape, std::size_t xi_threads, std::size_t xi_runs) {
+    const std::size_t nodes{ xi_shape.mParents.size() };
+    std::vector<std::int64_t> stamps(nodes);
+
+    // every node stamps the time it started
+    BabyTask::TaskGraph task_graph(xi_threads);
+    std::vector<BabyTask::BaseTaskNode*> graphNodes;
+    for (std::size_t i{}; i < nodes; ++i) {
+        auto node = task_graph.makeTaskNode([&stamps, i]() { stamps[i] = Now(); });
+        for (std::uint32_t parent : xi_shape.mParents[i]) {
+            node->setParent(*graphNodes[parent]);
+        }
+        graphNodes.push_back(node);
+    }
+    task_graph.execute();
+
+    std::vector<std::int64_t> latencies;
+    latencies.reserve(nodes * xi_runs);
+    std::int64_t total{};
+    for (std::size_t run{}; run < xi_runs; ++run) {
+        const std::int64_t start{ Now() };
+        task_graph.execute();
+        total += Now() - start;
+
+        // a node became ready when its last parent started (an empty task finishes right away)
+        for (std::size_t i{}; i < nodes; ++i) {
+            std::int64_t ready{ start };
+            for (std::uint32_t parent : xi_shape.mParents[i]) {
+                ready = std::max(ready, stamps[parent]);
+            }
+            latencies.push_back(stamps[i] - ready);
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) { return static_cast<double>(latencies[static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1))]); };
+    return ShapeResult{ static_cast<double>(nodes * xi_runs) * 1e9 / static_cast<double>(std::max<std::int64_t>(1, total)),
+                        percentile(0.5), percentile(0.9), percentile(0.99) };
+}
+
+/**
+* \brief Test3 style data parallel workload (fill two arrays, their min and max, and the average of both) with parallel nodes
+*
+* @param {size_t, in}  amount of elements per array
+* @param {size_t, in}  amount of threads
+* @param {size_t, in}  amount of executions
+* @param {double, out} elements per second
+**/
+double RunDataParallel(std::size_t xi_elements, std::size_t xi_threads, std::size_t xi_runs) {
+    std::vector<float> n0(xi_elements), n1(xi_elements);
+    float average{};
+
+    BabyTask::TaskGraph task_graph(xi_threads);
+    auto fill0 = task_graph.makeParallelForNode(std::size_t{}, xi_elements, 0, [&n0](std::size_t i) { n0[i] = static_cast<float>(i); });
+    auto fill1 = task_graph.makeParallelForNode(std::size_t{}, xi_elements, 0, [&n1](std::size_t i) { n1[i] = -static_cast<float>(i); });
+    auto min0 = task_graph.makeParallelReduceNode(std::size_t{}, xi_elements, 0, std::numeric_limits<float>::max(),
+                                                  [&n0](std::size_t b, std::size_t e, float partial) { return std::min(partial, *std::min_element(n0.begin() + b, n0.begin() + e)); },
+                                                  [](float a, float b) { return std::min(a, b); });
+    auto max1 = task_graph.makeParallelReduceNode(std::size_t{}, xi_elements, 0, std::numeric_limits<float>::lowest(),
+                                                  [&n1](std::size_t b, std::size_t e, float partial) { return std::max(partial, *std::max_element(n1.begin() + b, n1.begin() + e)); },
+                                                  [](float a, float b) { return std::max(a, b); });
+    auto result = task_graph.makeTaskNode([&average, min0, max1]() { average = 0.5f * (min0->getValue() + max1->getValue()); });
+    min0->setParent(*fill0);
+    max1->setParent(*fill1);
+    result->setParent(*min0);
+    result->setParent(*max1);
+
+    task_graph.execute();
+    const double seconds{ Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); }) };
+    return static_cast<double>(2 * xi_elements * xi_runs) / seconds;
+}
+
+/**
+* \brief run every shape at every thread count. scaling efficiency is throughput relative to
+*        the first thread count, divided by the relative amount of threads.
+*
+* @param {size_t,         in} amount of nodes per shape (and x100 elements for the data parallel workload)
+* @param {vector<size_t>, in} thread counts
+* @param {size_t,         in} amount of executions
+**/
+void ShapeBenchmark(std::size_t xi_nodes, const std::vector<std::size_t>& xi_threads, std::size_t xi_runs) {
+    std::printf("\nscheduler shapes (%zu nodes, %zu executions)\n", xi_nodes, xi_runs);
+    std::printf("%14s %8s %14s %12s %12s %12s %11s\n", "shape", "threads", "tasks/sec", "p50 (nsec)", "p90 (nsec)", "p99 (nsec)", "efficiency");
+
+    for (const char* name : { "empty", "chain", "fan", "tree", "layered" }) {
+        const Shape shape{ MakeShape(name, xi_nodes) };
+        double baseline{};
+        for (std::size_t threads : xi_threads) {
+            const ShapeResult result{ RunShape(shape, threads, xi_runs) };
+            if (baseline == 0.0) baseline = result.mTasksPerSecond / static_cast<double>(threads);
+            std::printf("%14s %8zu %14.0f %12.0f %12.0f %12.0f %10.0f%%\n", name, threads, result.mTasksPerSecond,
+                        result.mP50, result.mP90, result.mP99, 100.0 * result.mTasksPerSecond / (baseline * static_cast<double>(threads)));
+        }
+    }
+
+    double baseline{};
+    for (std::size_t threads : xi_threads) {
+        const double elements{ RunDataParallel(xi_nodes * 100, threads, xi_runs) };
+        if (baseline == 0.0) baseline = elements / static_cast<double>(threads);
+        std::printf("%14s %8zu %14.0f %12s %12s %12s %10.0f%%\n", "data-parallel", threads, elements, "-", "-", "-",
+                    100.0 * elements / (baseline * static_cast<double>(threads)));
+    }
+}
+
+/**
+* \brief bursty work: a small fan graph executed after an idle gap, for several idle worker spin budgets.
+*        reports wall time and process cpu time per burst, and idle loop counters per burst.
+*
+* @param {size_t, in} amount of threads
+* @param {size_t, in} amount of bursts
+**/
+void IdleBenchmark(std::size_t xi_threads, std::size_t xi_bursts) {
+    std::printf("\nidle workers (fan of 64 empty nodes after a 200usec gap, %zu threads, %zu bursts, per burst)\n", xi_threads, xi_bursts);
+    std::printf("%12s %10s %10s %10s %10s %10s %10s %10s\n", "spin/yield", "usec", "cpu usec", "spin hits", "yield hits", "parks", "wakeups", "skipped");
+
+    const Shape shape{ MakeShape("fan", 64) };
+    for (auto budget : { std::pair<std::size_t, std::size_t>{ 0, 0 }, { 16, 4 }, { 64, 16 }, { 1024, 64 }, { 16384, 256 } }) {
+        auto executor = std::make_shared<BabyTask::Executor>(xi_threads);
+        executor->pool().setSpinBudget(budget.first, budget.second);
+
+        BabyTask::TaskGraph task_graph(executor);
+        std::vector<BabyTask::BaseTaskNode*> graphNodes;
+        for (const auto& parents : shape.mParents) {
+            auto node = task_graph.makeTaskNode([]() {});
+            for (std::uint32_t parent : parents) {
+                node->setParent(*graphNodes[parent]);
+            }
+            graphNodes.push_back(node);
+        }
+        task_graph.execute();
+
+        const BabyTask::IdleStatistics before{ executor->pool().idleStatistics() };
+        const std::clock_t cpuStart{ std::clock() };
+        std::int64_t wall{};
+        for (std::size_t i{}; i < xi_bursts; ++i) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            const std::int64_t start{ Now() };
+            task_graph.execute();
+            wall += Now() - start;
+        }
+        const double cpu{ static_cast<double>(std::clock() - cpuStart) * 1e6 / CLOCKS_PER_SEC };
+        const BabyTask::IdleStatistics after{ executor->pool().idleStatistics() };
+
+        const double bursts{ static_cast<double>(xi_bursts) };
+        auto per = [bursts](std::uint64_t xi_after, std::uint64_t xi_before) { return static_cast<double>(xi_after - xi_before) / bursts; };
+        const std::string name{ std::to_string(budget.first) + "/" + std::to_string(budget.second) };
+        std::printf("%12s %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n", name.c_str(), static_cast<double>(wall) * 1e-3 / bursts, cpu / bursts,
+                    per(after.mSpinHits, before.mSpinHits), per(after.mYieldHits, before.mYieldHits), per(after.mParks, before.mParks),
+                    per(after.mNotifications, before.mNotifications), per(after.mSkippedNotifications, before.mSkippedNotifications));
+    }
+}
+
+/**
+* \brief incremental execution: a layered DAG where a few nodes near its end change between executions
+*
+* @param {size_t, in} amount of nodes
+* @param {size_t, in} amount of threads
+* @param {size_t, in} amount of executions
+**/
+void IncrementalBenchmark(std::size_t xi_nodes, std::size_t xi_threads, std::size_t xi_runs) {
+    const Shape shape{ MakeShape("layered", xi_nodes) };
+    BabyTask::TaskGraph task_graph(xi_threads);
+    std::vector<BabyTask::BaseTaskNode*> graphNodes;
+    for (const auto& parents : shape.mParents) {
+        auto node = task_graph.makeTaskNode([]() { Spin(std::chrono::microseconds(1)); });
+        for (std::uint32_t parent : parents) {
+            node->setParent(*graphNodes[parent]);
+        }
+        graphNodes.push_back(node);
+    }
+    task_graph.executeIncremental();
+
+    const double full{ Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); }) };
+
+    // dirty nodes are picked among the last 5% (a node only depends on nodes declared before it)
+    std::mt19937 random(7);
+    std::uniform_int_distribution<std::size_t> pick(xi_nodes - std::max<std::size_t>(1, xi_nodes / 20), xi_nodes - 1);
+    std::size_t executed{};
+    const double incremental{ Measure([&]() {
+        for (std::size_t i{}; i < xi_runs; ++i) {
+            for (std::size_t j{}; j < 4; ++j) {
+                task_graph.markDirty(*graphNodes[pick(random)]);
+            }
+            executed += task_graph.executeIncremental();
+        }
+    }) };
+
+    std::printf("\nincremental execution (layered DAG of %zu nodes, 1usec per node, %zu threads, msec/execution)\n", xi_nodes, xi_threads);
+    std::printf("%24s %10.3f\n%24s %10.3f (%.1f%% of nodes)\n", "full", full * 1e3 / static_cast<double>(xi_runs), "incremental",
+                incremental * 1e3 / static_cast<double>(xi_runs), 100.0 * static_cast<double>(executed) / static_cast<double>(xi_runs * xi_nodes));
+}
+
+/**
+* \brief memoization: a fan of pure nodes (10usec each) whose arguments repeat, with and without a shared result cache
+*
+* @param {size_t, in} amount of nodes
+* @param {size_t, in} amount of threads
+* @param {size_t, in} amount of executions
+**/
+void MemoBenchmark(std::size_t xi_nodes, std::size_t xi_threads, std::size_t xi_runs) {
+    auto run = [&](BabyTask::MemoCache* xi_cache) {
+        BabyTask::TaskGraph task_graph(xi_threads);
+        std::size_t round{};
+        const BabyTask::MemoDomain domain{ BabyTask::makeMemoDomain() };
+        auto source = task_graph.makeTaskNode([&round]() { return round++; });
+        for (std::size_t i{}; i < xi_nodes; ++i) {
+            // 64 distinct arguments per execution (shared by all nodes), which change every other execution
+            auto node = task_graph.makeTaskNode([i](std::size_t value) { Spin(std::chrono::microseconds(10)); return (i % 64) + value / 2; });
+            task_graph.connect<0>(*source, *node);
+            if (xi_cache) {
+                node->memoize(*xi_cache, domain, [i](const std::tuple<std::size_t>& arguments) { return static_cast<std::uint64_t>((i % 64) + std::get<0>(arguments) / 2); });
+            }
+        }
+        return Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) task_graph.execute(); });
+    };
+
+    BabyTask::MemoCache cache(std::size_t{ 1 } << 20);
+    const double plain{ run(nullptr) };
+    const double memoized{ run(&cache) };
+    const BabyTask::MemoStatistics statistics{ cache.statistics() };
+
+    std::printf("\nmemoization (fan of %zu nodes, 10usec per node, %zu threads, msec/execution)\n", xi_nodes, xi_threads);
+    std::printf("%24s %10.3f\n%24s %10.3f (%.1f%% hits, %llu evictions, %zu bytes)\n", "plain", plain * 1e3 / static_cast<double>(xi_runs), "memoized",
+                memoized * 1e3 / static_cast<double>(xi_runs), 100.0 * static_cast<double>(statistics.mHits) / static_cast<double>(statistics.mHits + statistics.mMisses),
+                static_cast<unsigned long long>(statistics.mEvictions), statistics.mBytes);
+}
+
+/**
+* \brief cancellation: how long a layered DAG (10usec per node) keeps running once its deadline has passed,
+*        and what an execution with a token (which is never cancelled) costs over a plain one on empty nodes
+*
+* @param {size_t, in} amount of nodes
+* @param {size_t, in} amount of threads
+* @param {size_t, in} amount of executions
+**/
+void CancelBenchmark(std::size_t xi_nodes, std::size_t xi_threads, std::size_t xi_runs) {
+    const Shape shape{ MakeShape("layered", xi_nodes) };
+    auto build = [&shape](BabyTask::TaskGraph& xo_graph, std::chrono::microseconds xi_work) {
+        std::vector<BabyTask::BaseTaskNode*> graphNodes;
+        for (const auto& parents : shape.mParents) {
+            auto node = xo_graph.makeTaskNode([xi_work]() { Spin(xi_work); });
+            for (std::uint32_t parent : parents) {
+                node->setParent(*graphNodes[parent]);
+            }
+            graphNodes.push_back(node);
+        }
+    };
+
+    BabyTask::TaskGraph slow_graph(xi_threads);
+    build(slow_graph, std::chrono::microseconds(10));
+    double overrun{};
+    for (std::size_t i{}; i < xi_runs; ++i) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+        slow_graph.execute(BabyTask::CancellationToken{}, deadline);
+        overrun += std::chrono::duration<double>(std::chrono::steady_clock::now() - deadline).count();
+    }
+
+    BabyTask::TaskGraph empty_graph(xi_threads);
+    build(empty_graph, std::chrono::microseconds(0));
+    BabyTask::CancellationToken token;
+    empty_graph.execute();
+    const double plain{ Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) empty_graph.execute(); }) };
+    const double cancellable{ Measure([&]() { for (std::size_t i{}; i < xi_runs; ++i) empty_graph.execute(token, std::chrono::steady_clock::now() + std::chrono::hours(1)); }) };
+
+    std::printf("\ncancellation (layered DAG of %zu nodes, %zu threads)\n", xi_nodes, xi_threads);
+    std::printf("%24s %10.3f msec past a 1msec deadline (10usec per node)\n", "overrun", overrun * 1e3 / static_cast<double>(xi_runs));
+    std::printf("%24s %10.3f msec/execution (empty nodes)\n%24s %10.3f msec/execution (empty nodes, token and deadline)\n",
+                "plain", plain * 1e3 / static_cast<double>(xi_runs), "cancellable", cancellable * 1e3 / static_cast<double>(xi_runs));
+}
+
+/**
+* \brief graph validation: building a DAG (with and without cycle checking as edges are declared), finding cycles and compiling it
+*
+* @param {vector<size_t>, in} amount of nodes per graph
+**/
+void ValidateBenchmark(const std::vector<std::size_t>& xi_nodes) {
+    std::printf("\ngraph validation (msec)\n%10s %10s %10s %12s %10s %10s\n", "shape", "nodes", "build", "build+check", "hasCycle", "compile");
+    for (const char* name : { "chain", "tree", "layered" }) {
+        for (std::size_t nodes : xi_nodes) {
+            const Shape shape{ MakeShape(name, nodes) };
+            auto build = [&shape](BabyTask::TaskGraph& xo_graph) {
+                std::vector<BabyTask::BaseTaskNode*> graphNodes;
+                for (const auto& parents : shape.mParents) {
+                    auto node = xo_graph.makeTaskNode([]() {});
+                    for (std::uint32_t parent : parents) {
+                        node->setParent(*graphNodes[parent]);
+                    }
+                    graphNodes.push_back(node);
+                }
+            };
+
+            BabyTask::TaskGraph plain(1), checked(1);
+            const double built{ Measure([&]() { build(plain); }) };
+            checked.setCycleChecking(true);
+            const double checking{ Measure([&]() { build(checked); }) };
+            bool cycle{};
+            const double search{ Measure([&]() { cycle = plain.hasCycle(); }) };
+            const double compile{ Measure([&]() { plain.compile(); }) };
+            std::printf("%10s %10zu %10.3f %12.3f %10.3f %10.3f%s\n", name, nodes, built * 1e3, checking * 1e3, search * 1e3, compile * 1e3, cycle ? " (cycle!)" : "");
+        }
+    }
+}
+
+// parse a comma separated list of numbers
+std::vector<std::size_t> ParseList(const char* xi_list) {
+    std::vector<std::size_t> values;
+    for (const char* c{ xi_list }; *c;) {
+        char* end{};
+        const std::size_t value{ static_cast<std::size_t>(std::strtoull(c, &end, 10)) };
+        if (end == c) break;
+        if (value > 0) values.push_back(value);
+        c = (*end == ',') ? end + 1 : end;
+    }
+    return values;
+}
+
+/**
+* usage: benchmarks [element count] [--suite=queue,graph,trace,priority,shapes,idle,incremental,memo,cancel,validate] [--nodes=N] [--threads=1,2,4] [--runs=R]
+**/
+int main(int argc, char* argv[]) {
+
+    // number of elements passed through queue
+    std::size_t count{ std::size_t{ 1 } << 20 };
+
+    // suites and shape parameters
+    std::string suites{ "queue,graph,trace,priority,shapes,idle,incremental,memo,cancel,validate" };
+    std::size_t nodes{ 10'000 }, runs{ 10 };
+    std::vector<std::size_t> threads;
+    for (std::size_t t{ 1 }; t <= BabyTask::Executor::defaultConcurrency(); t *= 2) {
+        threads.push_back(t);
+    }
+
+    for (int i{ 1 }; i < argc; ++i) {
+        const std::string argument{ argv[i] };
+        if (argument.rfind("--suite=", 0) == 0) suites = argument.substr(8);
+        else if (argument.rfind("--nodes=", 0) == 0) nodes = std::max<std::size_t>(2, std::strtoull(argv[i] + 8, nullptr, 10));
+        else if (argument.rfind("--threads=", 0) == 0) threads = ParseList(argv[i] + 10);
+        else if (argument.rfind("--runs=", 0) == 0) runs = std::max<std::size_t>(1, std::strtoull(argv[i] + 7, nullptr, 10));
+        else count = static_cast<std::size_t>(std::strtoull(argv[i], nullptr, 10));
+    }
+    if (threads.empty()) {
+        threads.push_back(1);
+    }
+
+    auto enabled = [&suites](const char* suite) { return ("," + suites + ",").find("," + std::string(suite) + ",") != std::string::npos; };
+    if (enabled("queue"))    QueueBenchmark(count);
+    if (enabled("graph"))    GraphBenchmark(count);
+    if (enabled("trace"))    TraceBenchmark(count);
+    if (enabled("priority")) PriorityBenchmark(std::max<std::size_t>(1, count >> 14));
+    if (enabled("shapes"))   ShapeBenchmark(nodes, threads, runs);
+    if (enabled("idle"))     IdleBenchmark(threads.back(), 100 * runs);
+    if (enabled("incremental")) IncrementalBenchmark(nodes, threads.back(), runs);
+    if (enabled("memo"))     MemoBenchmark(nodes / 10, threads.back(), runs);
+    if (enabled("cancel"))   CancelBenchmark(nodes, threads.back(), runs);
+    if (enabled("validate")) ValidateBenchmark({ nodes, 50 * nodes });
+
+    return 0;
+}
@@ -0,0 +1,240 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace BabyTask {
+
+    /**
+    * \brief lock free bounded multi producer / multi consumer queue (Vyukov ring buffer).
+    *        every cell holds a sequence number which tells which 'lap' of the ring
+    *        the cell is ready for, so producers and consumers only contend on a single CAS.
+    *
+    * @param {T} queue held element underlying type
+    **/
+    template<typename T> class BoundedQueue {
+
+        // a ring buffer cell
+        struct alignas(64) Cell {
+            std::atomic<std::size_t> mSequence;
+            T mData;
+        };
+
+        // properties
+        std::unique_ptr<Cell[]> mBuffer;                    // ring buffer
+        std::size_t mMask;                                  // ring buffer capacity - 1
+        alignas(64) std::atomic<std::size_t> mEnqueuePos;   // next position to push to
+        alignas(64) std::atomic<std::size_t> mDequeuePos;   // next position to pop from
+
+        // return difference between cell sequence and expected sequence
+        static std::intptr_t lap(std::size_t xi_sequence, std::size_t xi_expected) noexcept {
+            return static_cast<std::intptr_t>(xi_sequence) - static_cast<std::intptr_t>(xi_expected);
+        }
+
+        /**
+        * \brief claim up to 'xi_count' consecutive cells
+        *
+        * @param {atomic<size_t>, in}  position to claim from (mEnqueuePos or mDequeuePos)
+        * @param {size_t,         in}  cell sequence offset when ready (0 for push, 1 for pop)
+        * @param {size_t,         in}  maximal amount of cells to claim
+        * @param {size_t,         out} first claimed position
+        * @param {size_t,         out} amount of claimed cells
+        **/
+        std::size_t claim(std::atomic<std::size_t>& xio_position, std::size_t xi_offset, std::size_t xi_count, std::size_t& xo_first) noexcept {
+            if (xi_count > mMask + 1) xi_count = mMask + 1;
+            std::size_t pos{ xio_position.load(std::memory_order_relaxed) };
+
+            while (true) {
+                std::size_t ready{};
+                while (ready < xi_count) {
+                    const std::size_t sequence{ mBuffer[(pos + ready) & mMask].mSequence.load(std::memory_order_acquire) };
+                    if (lap(sequence, pos + ready + xi_offset) != 0) break;
+                    ++ready;
+                }
+
+                if (ready > 0) {
+                    if (xio_position.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed)) {
+                        xo_first = pos;
+                        return ready;
+                    }
+                }
+                else {
+                    // first cell is a lap behind (queue is full/empty) or 'pos' is stale
+                    const std::size_t sequence{ mBuffer[pos & mMask].mSequence.load(std::memory_order_acquire) };
+                    if (lap(sequence, pos + xi_offset) < 0) {
+                        return 0;
+                    }
+                    pos = xio_position.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // API
+        public:
+
+            // aliases
+            using value_type      = T;
+            using size_type       = std::size_t;
+            using reference       = T&;
+            using const_reference = const T&;
+
+            // construct with a given capacity (rounded up to a power of two)
+            explicit BoundedQueue(std::size_t xi_capacity = 1024) : mEnqueuePos(0), mDequeuePos(0) {
+                std::size_t capacity{ 2 };
+                while (capacity < xi_capacity) capacity <<= 1;
+
+                mBuffer.reset(new Cell[capacity]);
+                mMask = capacity - 1;
+                for (std::size_t i{}; i < capacity; ++i) {
+                    mBuffer[i].mSequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+            // copy semantics
+            BoundedQueue(const BoundedQueue&) = delete;
+            BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+            // move semantics
+            BoundedQueue(BoundedQueue&&) noexcept = delete;
+            BoundedQueue& operator=(BoundedQueue&&) noexcept = delete;
+
+            // return queue capacity
+            std::size_t capacity() const noexcept { return mMask + 1; }
+
+            /**
+            * \brief push new element to queue
+            *
+            * @param {T,    in}  element to pushed to queue
+            * @param {bool, out} true if operation was successful (false if queue is full)
+            **/
+            bool push(const T& xi_element) {
+                std::size_t pos;
+                if (claim(mEnqueuePos, 0, 1, pos) == 0) {
+                    return false;
+                }
+
+                Cell& cell = mBuffer[pos & mMask];
+                cell.mData = xi_element;
+                cell.mSequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool push(T&& xi_element) {
+                std::size_t pos;
+                if (claim(mEnqueuePos, 0, 1, pos) == 0) {
+                    return false;
+                }
+
+                Cell& cell = mBuffer[pos & mMask];
+                cell.mData = std::move(xi_element);
+                cell.mSequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+            * \brief pop (remove and return) queue front element
+            *
+            * @param {T,    out} queue front element
+            * @param {bool, out} true if operation was successful (false if queue is empty)
+            **/
+            bool pop(T& xo_element) {
+                std::size_t pos;
+                if (claim(mDequeuePos, 1, 1, pos) == 0) {
+                    return false;
+                }
+
+                Cell& cell = mBuffer[pos & mMask];
+                xo_element = std::move(cell.mData);
+                cell.mSequence.store(pos + mMask + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+            * \brief push (move) several elements to queue in one operation
+            *
+            * @param {T*,     in}  elements to be pushed
+            * @param {size_t, in}  amount of elements
+            * @param {size_t, out} amount of elements pushed (less than requested if queue is full)
+            **/
+            std::size_t push_bulk(T* xi_elements, std::size_t xi_count) {
+                std::size_t pushed{};
+
+                while (pushed < xi_count) {
+                    std::size_t pos;
+                    const std::size_t len{ claim(mEnqueuePos, 0, xi_count - pushed, pos) };
+                    if (len == 0) break;
+
+                    for (std::size_t i{}; i < len; ++i) {
+                        Cell& cell = mBuffer[(pos + i) & mMask];
+                        cell.mData = std::move(xi_elements[pushed + i]);
+                        cell.mSequence.store(pos + i + 1, std::memory_order_release);
+                    }
+                    pushed += len;
+                }
+
+                return pushed;
+            }
+
+            /**
+            * \brief pop (move) several elements from queue in one operation
+            *
+            * @param {T*,     out} popped elements
+            * @param {size_t, in}  maximal amount of elements to pop
+            * @param {size_t, out} amount of elements popped
+            **/
+            std::size_t pop_bulk(T* xo_elements, std::size_t xi_count) {
+                std::size_t popped{};
+
+                while (popped < xi_count) {
+                    std::size_t pos;
+                    const std::size_t len{ claim(mDequeuePos, 1, xi_count - popped, pos) };
+                    if (len == 0) break;
+
+                    for (std::size_t i{}; i < len; ++i) {
+                        Cell& cell = mBuffer[(pos + i) & mMask];
+                        xo_elements[popped + i] = std::move(cell.mData);
+                        cell.mSequence.store(pos + i + mMask + 1, std::memory_order_release);
+                    }
+                    popped += len;
+                }
+
+                return popped;
+            }
+
+            /**
+            * \brief test if queue is empty (a snapshot, might be stale once returned)
+            *
+            * @param {bool, out} true if queue is empty
+            **/
+            bool empty() const noexcept {
+                return mDequeuePos.load(std::memory_order_acquire) >= mEnqueuePos.load(std::memory_order_acquire);
+            }
+    };
+};
\ No newline at end of file
@@ -0,0 +1,79 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace BabyTask {
+
+    class TaskGraph;
+
+    /**
+    * \brief outcome of a graph execution
+    **/
+    enum class ExecutionStatus : std::uint8_t {
+        Completed,          // every node ran
+        Cancelled,          // execution token was cancelled (nodes which had not started were skipped)
+        DeadlineExceeded,   // execution deadline has passed (nodes which had not started were skipped)
+        Failed              // a task has thrown (nodes which had not started were skipped, the exception is rethrown to the waiter)
+    };
+
+    // execution deadline
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    // 'no deadline'
+    inline constexpr Deadline NoDeadline{ Deadline::max() };
+
+    /**
+    * \brief cooperative cancellation token. copies share one state, so a token handed to an execution can be cancelled
+    *        from any thread (i.e. - by a copy held by a request handler). cancellation is sticky.
+    *        an execution skips its nodes which have not started yet once its token is cancelled,
+    *        running nodes can poll the token (or 'TaskGraph::stopRequested').
+    **/
+    class CancellationToken {
+
+        // friends
+        friend class TaskGraph;
+
+        // properties
+        std::shared_ptr<std::atomic<bool>> mCancelled;
+
+        // API
+        public:
+
+            // constructor (a token which is not cancelled)
+            CancellationToken() : mCancelled(std::make_shared<std::atomic<bool>>(false)) {}
+
+            // request cancellation (of every execution this token was handed to)
+            void cancel() noexcept { mCancelled->store(true, std::memory_order_release); }
+
+            // test if cancellation was requested
+            bool isCancelled() const noexcept { return mCancelled->load(std::memory_order_acquire); }
+    };
+};
@@ -0,0 +1,87 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "BaseTaskNode.h"
+#include <type_traits>
+#include <utility>
+
+namespace BabyTask {
+
+    class TaskGraph;
+
+    /**
+    * \brief a node whose callable returns the index of the successor (in the order successors were declared) which runs next.
+    *        the other successors - and every node reachable only through them - are skipped without being scheduled.
+    *        an index out of range skips all successors.
+    *
+    * @param {TaskCallback} callable type (callable as 'integral()')
+    **/
+    template<typename TaskCallback>
+    class ConditionNode : public BaseTaskNode {
+        static_assert(std::is_integral_v<std::invoke_result_t<TaskCallback&>>, "condition node callable must return a successor index.");
+
+        // friends
+        friend class TaskGraph;
+
+        // properties
+        TaskCallback mCallback;     // branch selector
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {TaskGraph*,      in} graph
+            * @param {TaskCallback,    in} callable
+            * @param {string_view,     in} node name
+            * @param {memory_resource, in} graph arena
+            **/
+            ConditionNode(TaskGraph* xi_graph, TaskCallback xi_callback, std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                BaseTaskNode(xi_graph, xi_name, xi_resource), mCallback(std::move(xi_callback)) {
+                mCondition = true;
+            }
+
+            // choose a branch
+            virtual bool execute() override {
+                const auto branch = mCallback();
+                if constexpr (std::is_signed_v<decltype(branch)>) {
+                    mBranch = (branch < 0) ? NoBranch : static_cast<std::size_t>(branch);
+                }
+                else {
+                    mBranch = static_cast<std::size_t>(branch);
+                }
+                return true;
+            }
+
+            // return branch chosen by last execution (NoBranch if none)
+            std::size_t getBranch() const { return mBranch; }
+
+            // BaseTaskNode interface
+            virtual void reset() override { mBranch = NoBranch; }
+    };
+};
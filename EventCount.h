@@ -0,0 +1,152 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace BabyTask {
+
+    // hint the cpu that the calling thread is busy waiting
+    inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64)
+        _mm_pause();
+#endif
+    }
+
+    /**
+    * \brief eventcount - lets a thread sleep until a condition (checked outside of it) might have changed,
+    *        while a notifier which finds no sleeping thread pays a fence and a load (no mutex, no system call).
+    *
+    *        waiter:                                        notifier:
+    *          key = prepareWait();                           make condition true;
+    *          if (condition) { cancelWait(); return; }       notify();
+    *          commitWait(key);
+    **/
+    class EventCount {
+
+        static constexpr std::uint64_t WaiterMask = 0xffffffffull;    // lower half - amount of waiters
+        static constexpr std::uint64_t EpochIncrement = 1ull << 32;   // upper half - notification epoch
+
+        // properties
+        std::atomic<std::uint64_t> mState;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+
+        // bump epoch and wake waiters (if there are any)
+        bool signal(bool xi_all) {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if ((mState.load(std::memory_order_acquire) & WaiterMask) == 0) {
+                return false;
+            }
+
+            mState.fetch_add(EpochIncrement, std::memory_order_acq_rel);
+            {
+                // a waiter checks the epoch while holding the mutex, so it is either waiting or sees the new epoch
+                std::unique_lock<std::mutex> lock(mMutex);
+            }
+
+            if (xi_all) {
+                mCondition.notify_all();
+            }
+            else {
+                mCondition.notify_one();
+            }
+            return true;
+        }
+
+        // API
+        public:
+
+            // wait ticket
+            using Key = std::uint32_t;
+
+            EventCount() noexcept : mState(0) {}
+
+            // copy semantics
+            EventCount(const EventCount&) = delete;
+            EventCount& operator=(const EventCount&) = delete;
+
+            // move semantics
+            EventCount(EventCount&&) noexcept = delete;
+            EventCount& operator=(EventCount&&) noexcept = delete;
+
+            /**
+            * \brief announce an upcoming wait (the condition must be checked again before committing to it)
+            *
+            * @param {Key, out} wait ticket
+            **/
+            Key prepareWait() {
+                return static_cast<Key>(mState.fetch_add(1, std::memory_order_seq_cst) >> 32);
+            }
+
+            // abandon a prepared wait (condition became true)
+            void cancelWait() {
+                mState.fetch_sub(1, std::memory_order_seq_cst);
+            }
+
+            /**
+            * \brief sleep until a notification issued after 'prepareWait'
+            *
+            * @param {Key, in} wait ticket
+            **/
+            void commitWait(Key xi_key) {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    while (static_cast<Key>(mState.load(std::memory_order_acquire) >> 32) == xi_key) {
+                        mCondition.wait(lock);
+                    }
+                }
+                mState.fetch_sub(1, std::memory_order_seq_cst);
+            }
+
+            /**
+            * \brief wake one waiter
+            *
+            * @param {bool, out} false if no thread was waiting (nothing was done)
+            **/
+            bool notify() { return signal(false); }
+
+            /**
+            * \brief wake all waiters
+            *
+            * @param {bool, out} false if no thread was waiting (nothing was done)
+            **/
+            bool notifyAll() { return signal(true); }
+
+            // return amount of threads which prepared or committed to a wait
+            std::uint32_t waiters() const { return static_cast<std::uint32_t>(mState.load(std::memory_order_relaxed) & WaiterMask); }
+    };
+};
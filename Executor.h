@@ -0,0 +1,108 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "ThreadPool.h"
+#include <thread>
+
+namespace BabyTask {
+
+    /**
+    * \brief executor - a work stealing thread pool which several task graphs share.
+    *        graphs hold it by shared pointer, so it lives as long as the last graph using it.
+    *        progress is fair across graphs: every graph starts through the (FIFO) shared queue,
+    *        a worker periodically takes the oldest task available instead of its newest descendant,
+    *        and inline execution of descendants is capped per pool task.
+    **/
+    class Executor {
+
+        // properties
+        LockFreeThreadPool mPool;
+
+        // API
+        public:
+
+            // return default amount of threads (hardware concurrency, at least one)
+            static std::size_t defaultConcurrency() {
+                const std::size_t count{ std::thread::hardware_concurrency() };
+                return (count > 0) ? count : 1;
+            }
+
+            // construct with a given number of threads (default is hardware concurrency)
+            explicit Executor(std::size_t xi_count = defaultConcurrency()) : mPool(xi_count, SchedulingPolicy::WorkStealing) {}
+
+            /**
+            * \brief construct with a given number of threads pinned to cpus
+            *
+            * @param {size_t,      in} number of threads
+            * @param {Placement,   in} worker placement (compact, scatter or explicit cpu set)
+            * @param {CpuTopology, in} NUMA topology (default is the topology of this machine)
+            **/
+            Executor(std::size_t xi_count, const Placement& xi_placement, const CpuTopology& xi_topology = CpuTopology::system()) :
+                mPool(xi_count, SchedulingPolicy::WorkStealing, xi_placement, xi_topology) {}
+
+            // copy semantics
+            Executor(const Executor&) = delete;
+            Executor& operator=(const Executor&) = delete;
+
+            // move semantics
+            Executor(Executor&&) noexcept = delete;
+            Executor& operator=(Executor&&) noexcept = delete;
+
+            // return number of threads
+            std::size_t size() const { return mPool.size(); }
+
+            // return amount of NUMA nodes tasks can be hinted to (zero if workers are not pinned)
+            std::size_t nodeCount() const { return mPool.nodeCount(); }
+
+            // return NUMA node of the calling worker (AnyNode if called by a non pool thread)
+            std::size_t currentNode() const { return mPool.currentNode(); }
+
+            // return underlying thread pool
+            LockFreeThreadPool& pool() { return mPool; }
+
+            /**
+            * \brief push a task to executor (fire and forget)
+            *
+            * @param {F, in} task (callable as 'void(std::size_t id)')
+            **/
+            template<typename F>
+            void submit(F&& xi_task) {
+                mPool.submit(std::forward<F>(xi_task));
+            }
+
+            /**
+            * \brief push a task which prefers workers of a given NUMA node (fire and forget)
+            *
+            * @param {F,      in} task (callable as 'void(std::size_t id)')
+            * @param {size_t, in} NUMA node (AnyNode for no preference)
+            **/
+            template<typename F>
+            void submit(F&& xi_task, std::size_t xi_node) {
+                mPool.submit(std::forward<F>(xi_task), xi_node);
+            }
+    };
+};
\ No newline at end of file
@@ -0,0 +1,260 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace BabyTask {
+
+    /**
+    * \brief memoization domain - a cached result is handed only to nodes memoized in the domain it was cached in
+    **/
+    enum class MemoDomain : std::uint64_t {};
+
+    /**
+    * \brief make a new memoization domain (unique within the process)
+    *
+    * @param {MemoDomain, out} domain
+    **/
+    inline MemoDomain makeMemoDomain() noexcept {
+        static std::atomic<std::uint64_t> next{ 1 };
+        return static_cast<MemoDomain>(next.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    /**
+    * \brief memoization cache counters
+    **/
+    struct MemoStatistics {
+        std::uint64_t mHits{};          // lookups which found a result
+        std::uint64_t mMisses{};        // lookups which found nothing
+        std::uint64_t mInsertions{};    // results inserted
+        std::uint64_t mEvictions{};     // results evicted to stay within capacity
+        std::size_t mEntries{};         // results currently held
+        std::size_t mBytes{};           // bytes currently charged
+    };
+
+    /**
+    * \brief bounded, sharded, thread safe LRU cache of task results, addressed by a hash of their arguments.
+    *        results are held as immutable shared views (a hit does not copy the result, a shared view consumer gets it as is).
+    *        every shard holds an equal part of the memory cap and has its own lock, its own LRU list and its own counters.
+    *        an entry is charged its result size (as reported when inserted) and its bookkeeping size.
+    *        a cache can be shared by any amount of nodes and graphs.
+    **/
+    class MemoCache {
+
+        // entry key - argument hash, the domain it belongs to and the result type (so a domain never hands a result of another type)
+        struct Key {
+            std::uint64_t mHash;
+            MemoDomain mDomain;
+            const void* mType;
+
+            bool operator==(const Key& xi_other) const noexcept {
+                return (mHash == xi_other.mHash) && (mDomain == xi_other.mDomain) && (mType == xi_other.mType);
+            }
+        };
+
+        // result type tag (unique per type)
+        template<typename T>
+        static const void* type() noexcept {
+            static const char tag{};
+            return &tag;
+        }
+
+        // mix key bits (splitmix64 finalizer)
+        static std::uint64_t mix(const Key& xi_key) noexcept {
+            std::uint64_t x{ xi_key.mHash ^ (static_cast<std::uint64_t>(xi_key.mDomain) * 0x9e3779b97f4a7c15ull) ^
+                             static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(xi_key.mType)) };
+            x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+            x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+            return x ^ (x >> 31);
+        }
+
+        struct KeyHash {
+            std::size_t operator()(const Key& xi_key) const noexcept { return static_cast<std::size_t>(mix(xi_key)); }
+        };
+
+        // cached result
+        struct Entry {
+            Key mKey;
+            std::shared_ptr<const void> mValue;
+            std::size_t mBytes;
+        };
+
+        // amount of bytes an entry costs besides its result
+        static constexpr std::size_t EntryOverhead = sizeof(Entry) + 4 * sizeof(void*);
+
+        // a cache shard (most recently used entry first)
+        struct alignas(64) Shard {
+            std::mutex mMutex;
+            std::list<Entry> mEntries;
+            std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> mIndex;
+            std::size_t mBytes{};
+            MemoStatistics mStatistics;
+        };
+
+        // properties
+        std::unique_ptr<Shard[]> mShards;
+        std::size_t mShardCount;
+        std::size_t mShardCapacity;
+        std::size_t mCapacity;
+
+        // return shard a key belongs to (upper mixed bits, lower ones index shard map)
+        Shard& shard(const Key& xi_key) const noexcept {
+            return mShards[static_cast<std::size_t>(mix(xi_key) >> 40) & (mShardCount - 1)];
+        }
+
+        // API
+        public:
+
+            /**
+            * \brief construct a cache
+            *
+            * @param {size_t, in} memory cap (in bytes)
+            * @param {size_t, in} amount of shards (rounded up to a power of two)
+            **/
+            explicit MemoCache(std::size_t xi_capacity, std::size_t xi_shards = 16) : mShardCount(1), mCapacity(xi_capacity) {
+                while (mShardCount < xi_shards) {
+                    mShardCount <<= 1;
+                }
+                mShards = std::make_unique<Shard[]>(mShardCount);
+                mShardCapacity = xi_capacity / mShardCount;
+            }
+
+            // copy semantics
+            MemoCache(const MemoCache&) = delete;
+            MemoCache& operator=(const MemoCache&) = delete;
+
+            // move semantics
+            MemoCache(MemoCache&&) noexcept = delete;
+            MemoCache& operator=(MemoCache&&) noexcept = delete;
+
+            /**
+            * \brief look a result up (and mark it as most recently used)
+            *
+            * @param {uint64_t,   in}  argument hash
+            * @param {MemoDomain, in}  domain the hash belongs to
+            * @param {shared_ptr, out} result (empty if not cached)
+            **/
+            template<typename T>
+            std::shared_ptr<const T> find(std::uint64_t xi_hash, MemoDomain xi_domain) {
+                const Key key{ xi_hash, xi_domain, type<T>() };
+                Shard& current = shard(key);
+                std::unique_lock<std::mutex> lock(current.mMutex);
+
+                auto it = current.mIndex.find(key);
+                if (it == current.mIndex.end()) {
+                    ++current.mStatistics.mMisses;
+                    return {};
+                }
+
+                ++current.mStatistics.mHits;
+                current.mEntries.splice(current.mEntries.begin(), current.mEntries, it->second);
+                return std::static_pointer_cast<const T>(it->second->mValue);
+            }
+
+            /**
+            * \brief insert a result (replacing a result cached under the same key), evicting least recently used
+            *        results of its shard until it fits. a result larger than a shard share of the memory cap is not cached.
+            *
+            * @param {uint64_t,   in} argument hash
+            * @param {MemoDomain, in} domain the hash belongs to
+            * @param {shared_ptr, in} result
+            * @param {size_t,     in} result size (in bytes)
+            **/
+            template<typename T>
+            void insert(std::uint64_t xi_hash, MemoDomain xi_domain, std::shared_ptr<const T> xi_value, std::size_t xi_bytes) {
+                const Key key{ xi_hash, xi_domain, type<T>() };
+                const std::size_t bytes{ xi_bytes + EntryOverhead };
+                if (bytes > mShardCapacity) {
+                    return;
+                }
+
+                Shard& current = shard(key);
+                std::unique_lock<std::mutex> lock(current.mMutex);
+
+                if (auto it = current.mIndex.find(key); it != current.mIndex.end()) {
+                    current.mBytes -= it->second->mBytes;
+                    current.mEntries.erase(it->second);
+                    current.mIndex.erase(it);
+                }
+
+                while (current.mBytes + bytes > mShardCapacity) {
+                    const Entry& victim = current.mEntries.back();
+                    current.mBytes -= victim.mBytes;
+                    current.mIndex.erase(victim.mKey);
+                    current.mEntries.pop_back();
+                    ++current.mStatistics.mEvictions;
+                }
+
+                current.mEntries.push_front(Entry{ key, std::move(xi_value), bytes });
+                current.mIndex.emplace(key, current.mEntries.begin());
+                current.mBytes += bytes;
+                ++current.mStatistics.mInsertions;
+            }
+
+            /**
+            * \brief return counters (summed over all shards)
+            *
+            * @param {MemoStatistics, out} counters
+            **/
+            MemoStatistics statistics() const {
+                MemoStatistics statistics;
+                for (std::size_t i{}; i < mShardCount; ++i) {
+                    Shard& current = mShards[i];
+                    std::unique_lock<std::mutex> lock(current.mMutex);
+                    statistics.mHits += current.mStatistics.mHits;
+                    statistics.mMisses += current.mStatistics.mMisses;
+                    statistics.mInsertions += current.mStatistics.mInsertions;
+                    statistics.mEvictions += current.mStatistics.mEvictions;
+                    statistics.mEntries += current.mEntries.size();
+                    statistics.mBytes += current.mBytes;
+                }
+                return statistics;
+            }
+
+            // discard all results (counters are kept)
+            void clear() {
+                for (std::size_t i{}; i < mShardCount; ++i) {
+                    Shard& current = mShards[i];
+                    std::unique_lock<std::mutex> lock(current.mMutex);
+                    current.mIndex.clear();
+                    current.mEntries.clear();
+                    current.mBytes = 0;
+                }
+            }
+
+            // return memory cap (in bytes)
+            std::size_t capacity() const noexcept { return mCapacity; }
+
+            // return amount of shards
+            std::size_t shardCount() const noexcept { return mShardCount; }
+    };
+};
@@ -0,0 +1,292 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "BaseTaskNode.h"
+#include <optional>
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+
+namespace BabyTask {
+
+    class TaskGraph;
+
+    /**
+    * \brief a node which processes a range of indices [begin, end) on several pool workers.
+    *        the worker executing the node and up to 'executor size - 1' helpers claim chunks of the range
+    *        from a shared counter, where a chunk is a share of the remaining range which shrinks as the range
+    *        is consumed (but is never smaller than the grain size), so uneven chunks are balanced across workers.
+    *        node descendants start only once the whole range is processed, by the participants which joined in
+    *        (a helper which is dequeued after the node has finished does not delay it).
+    *
+    * @param {Index} range index type (integral)
+    **/
+    template<typename Index>
+    class ParallelTaskNode : public BaseTaskNode {
+        static_assert(std::is_integral_v<Index>, "parallel node range index must be integral.");
+
+        // friends
+        friend class TaskGraph;
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {TaskGraph*,      in} graph
+            * @param {Index,           in} range begin
+            * @param {Index,           in} range end
+            * @param {size_t,          in} minimal chunk size (0 - chosen by amount of workers)
+            * @param {string_view,     in} node name
+            * @param {memory_resource, in} graph arena
+            **/
+            ParallelTaskNode(TaskGraph* xi_graph, Index xi_begin, Index xi_end, std::size_t xi_grain, std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                BaseTaskNode(xi_graph, xi_name, xi_resource), mBegin(xi_begin), mEnd(xi_end), mGrain(xi_grain) {}
+
+            /**
+            * \brief split range between pool workers (defined in TaskGraph.h)
+            *
+            * @param {bool, out} true if range was completely processed by the calling thread
+            **/
+            virtual bool execute() override;
+
+            // return range
+            Index begin() const { return mBegin; }
+            Index end() const { return mEnd; }
+
+            // return minimal chunk size (0 - chosen by amount of workers)
+            std::size_t getGrain() const { return mGrain; }
+
+        // internals
+        protected:
+
+            /**
+            * \brief process a chunk of the range
+            *
+            * @param {Index,  in} chunk begin
+            * @param {Index,  in} chunk end
+            * @param {size_t, in} participant (0 - the worker which executed the node)
+            **/
+            virtual void runChunk(Index xi_begin, Index xi_end, std::size_t xi_participant) = 0;
+
+            // called before any chunk is processed
+            virtual void onStart(std::size_t) {}
+
+            // called once all chunks were processed (by the last participant)
+            virtual void onFinish() {}
+
+        private:
+
+            // properties
+            Index mBegin;                           // range begin
+            Index mEnd;                             // range end
+            std::size_t mGrain;                     // minimal chunk size requested by user
+            std::size_t mChunkGrain{ 1 };           // minimal chunk size (in current execution)
+            std::size_t mParticipants{ 1 };         // amount of workers processing the range (in current execution)
+            std::atomic<Index> mNext{};             // first index which was not claimed yet
+            std::uint32_t mRun{};                   // execution counter (a node might be executed again within one graph execution)
+            std::atomic<std::uint64_t> mState{};    // execution counter (high half) and amount of joined participants which did not finish yet (low half)
+
+            /**
+            * \brief join the participants of a given execution (fails if that execution of the node has already finished)
+            *
+            * @param {uint32_t, in}  execution counter (when helper was submitted)
+            * @param {bool,     out} true if helper joined
+            **/
+            bool join(std::uint32_t xi_run) noexcept {
+                std::uint64_t state{ mState.load(std::memory_order_acquire) };
+                while (((state >> 32) == xi_run) && ((state & 0xffffffffu) > 0)) {
+                    if (mState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            /**
+            * \brief claim a chunk - a share of the remaining range which is never smaller than the grain size
+            *
+            * @param {Index, out} chunk begin
+            * @param {Index, out} chunk end
+            * @param {bool,  out} false if range is exhausted
+            **/
+            bool claim(Index& xo_begin, Index& xo_end) noexcept {
+                Index current{ mNext.load(std::memory_order_relaxed) };
+                while (current < mEnd) {
+                    const std::size_t remaining{ static_cast<std::size_t>(mEnd - current) };
+                    const std::size_t size{ std::min(remaining, std::max(mChunkGrain, remaining / (2 * mParticipants))) };
+                    if (mNext.compare_exchange_weak(current, static_cast<Index>(current + static_cast<Index>(size)), std::memory_order_relaxed)) {
+                        xo_begin = current;
+                        xo_end = static_cast<Index>(current + static_cast<Index>(size));
+                        return true;
+                    }
+                }
+
+                return false;
+            }
+
+            /**
+            * \brief process chunks until range is exhausted (or graph execution should stop)
+            *
+            * @param {size_t, in}  participant
+            * @param {bool,   out} true if this was the last participant to finish
+            **/
+            bool participate(std::size_t xi_participant) {
+                Index begin{}, end{};
+                try {
+                    while (!stopRequested() && claim(begin, end)) {
+                        runChunk(begin, end, xi_participant);
+                    }
+                }
+                catch (...) {
+                    fail();
+                }
+
+                if ((mState.fetch_sub(1, std::memory_order_acq_rel) & 0xffffffffu) == 1) {
+                    try {
+                        onFinish();
+                    }
+                    catch (...) {
+                        fail();
+                    }
+                    return true;
+                }
+
+                return false;
+            }
+
+            // test if graph execution should stop (remaining chunks are not claimed), defined in TaskGraph.h
+            bool stopRequested() const;
+
+            // fail graph execution with the exception being handled (remaining chunks are not claimed), defined in TaskGraph.h
+            void fail() const;
+
+            // BaseTaskNode interface
+            virtual void reset() override {}
+    };
+
+    /**
+    * \brief parallel for - call 'body(i)' for every index in range
+    *
+    * @param {Index} range index type
+    * @param {Body}  body type (callable as 'void(Index)')
+    **/
+    template<typename Index, typename Body>
+    class ParallelForNode final : public ParallelTaskNode<Index> {
+
+        // properties
+        Body mBody;
+
+        // process chunk
+        virtual void runChunk(Index xi_begin, Index xi_end, std::size_t) override {
+            for (Index i{ xi_begin }; i < xi_end; ++i) {
+                mBody(i);
+            }
+        }
+
+        // API
+        public:
+
+            // value constructor
+            ParallelForNode(TaskGraph* xi_graph, Index xi_begin, Index xi_end, std::size_t xi_grain, Body xi_body, std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                ParallelTaskNode<Index>(xi_graph, xi_begin, xi_end, xi_grain, xi_name, xi_resource), mBody(std::move(xi_body)) {}
+    };
+
+    /**
+    * \brief parallel reduce - every participant folds its chunks into a partial result ('body(begin, end, partial)'),
+    *        and partial results are then combined ('combine(left, right)'). 'combine' should be associative and
+    *        commutative, since the way the range is split changes from one execution to another.
+    *
+    * @param {Index}   range index type
+    * @param {T}       result type
+    * @param {Body}    body type (callable as 'T(Index begin, Index end, T partial)')
+    * @param {Combine} combine type (callable as 'T(T, T)')
+    **/
+    template<typename Index, typename T, typename Body, typename Combine>
+    class ParallelReduceNode final : public ParallelTaskNode<Index> {
+
+        // partial result (on its own cache line)
+        struct alignas(64) Partial {
+            T mValue;
+        };
+
+        // properties
+        T mIdentity;
+        Body mBody;
+        Combine mCombine;
+        std::vector<Partial> mPartials;
+        std::optional<T> mResult;
+
+        // reset partial results
+        virtual void onStart(std::size_t xi_participants) override {
+            mResult.reset();
+            mPartials.assign(xi_participants, Partial{ mIdentity });
+        }
+
+        // fold chunk into participant partial result
+        virtual void runChunk(Index xi_begin, Index xi_end, std::size_t xi_participant) override {
+            T& partial = mPartials[xi_participant].mValue;
+            partial = mBody(xi_begin, xi_end, std::move(partial));
+        }
+
+        // combine partial results
+        virtual void onFinish() override {
+            T result{ std::move(mPartials[0].mValue) };
+            for (std::size_t i{ 1 }; i < mPartials.size(); ++i) {
+                result = mCombine(std::move(result), std::move(mPartials[i].mValue));
+            }
+            mResult = std::move(result);
+        }
+
+        // API
+        public:
+
+            // value constructor
+            ParallelReduceNode(TaskGraph* xi_graph, Index xi_begin, Index xi_end, std::size_t xi_grain, T xi_identity, Body xi_body, Combine xi_combine,
+                               std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                ParallelTaskNode<Index>(xi_graph, xi_begin, xi_end, xi_grain, xi_name, xi_resource),
+                mIdentity(std::move(xi_identity)), mBody(std::move(xi_body)), mCombine(std::move(xi_combine)) {}
+
+            /**
+            * \brief get reduction result
+            **/
+            T getValue() const {
+                if (!mResult) {
+                    throw std::logic_error("node has no result.");
+                }
+                return mResult.value();
+            }
+
+            // BaseTaskNode interface
+            virtual void reset() override { mResult.reset(); }
+    };
+};
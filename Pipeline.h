@@ -0,0 +1,333 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "Executor.h"
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <vector>
+#include <limits>
+#include <stdexcept>
+
+namespace BabyTask {
+
+    /**
+    * \brief pipeline stage execution mode
+    **/
+    enum class StageMode { SerialInOrder,   // one token at a time, in the order the source produced them
+                           Parallel };      // any number of tokens at a time
+
+    /**
+    * \brief streaming pipeline - a source produces a stream of tokens which pass through a linear chain of stages.
+    *        at most 'tokens' tokens are in flight at once (each one is held in its own 'line'), so a slow stage
+    *        stops the source instead of letting records pile up (backpressure).
+    *        a token which reaches a serial stage before its turn is parked in the stage buffer (bounded by the amount of lines),
+    *        and is resumed by the token ahead of it once the stage is done with it.
+    *        different tokens run different stages at the same time, so throughput scales with cores.
+    *
+    * @param {T} token type (a line holds one, and it is reused by the tokens which pass through that line)
+    **/
+    template<typename T> class Pipeline {
+
+        // aliases
+        using StageCallback = std::function<void(T&)>;
+        using SourceCallback = std::function<bool(T&)>;
+        static constexpr std::size_t NoLine = std::numeric_limits<std::size_t>::max();
+
+        // a stage
+        struct Stage {
+            StageCallback mCallback;
+            StageMode mMode;
+            std::mutex mMutex;                          // guards serial stage order
+            std::size_t mNext{};                        // sequence number of next token to enter serial stage
+            std::unique_ptr<std::size_t[]> mParked;     // lines waiting for their turn (indexed by sequence number modulo amount of lines)
+        };
+
+        // a line (one token in flight)
+        struct Line {
+            T mToken{};
+            std::size_t mSequence{};
+        };
+
+        // properties
+        std::shared_ptr<Executor> mExecutor;
+        std::vector<std::unique_ptr<Stage>> mStages;
+        std::vector<Line> mLines;
+        SourceCallback mSource;
+        std::mutex mSourceMutex;
+        std::size_t mProduced;                  // amount of tokens produced by source (guarded by mSourceMutex)
+        bool mExhausted;                        // source has nothing more to produce (guarded by mSourceMutex)
+        std::atomic<std::size_t> mActiveLines;  // lines which did not finish yet
+        bool mRunning;                          // guarded by mMutex
+        std::atomic<bool> mFailed;              // a stage (or the source) has thrown
+        std::exception_ptr mException;          // first exception thrown by a stage or the source (guarded by mMutex)
+        std::mutex mMutex;
+        std::condition_variable mConditionVariable;
+
+        // internals
+
+        /**
+        * \brief produce a new token on a line
+        *
+        * @param {size_t, in}  line
+        * @param {bool,   out} false if source is exhausted
+        **/
+        bool produce(std::size_t xi_line) {
+            std::unique_lock<std::mutex> lock(mSourceMutex);
+            if (mExhausted) {
+                return false;
+            }
+
+            Line& line = mLines[xi_line];
+            bool produced{ false };
+            try {
+                produced = mSource(line.mToken);
+            }
+            catch (...) {
+                fail(std::current_exception());
+            }
+
+            if (!produced) {
+                mExhausted = true;
+                return false;
+            }
+
+            line.mSequence = mProduced++;
+            return true;
+        }
+
+        /**
+        * \brief record the first exception thrown by a stage or the source, no new tokens are produced from now on
+        *
+        * @param {exception_ptr, in} exception
+        **/
+        void fail(std::exception_ptr xi_exception) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (!mException) {
+                mException = std::move(xi_exception);
+            }
+            mFailed.store(true, std::memory_order_release);
+        }
+
+        /**
+        * \brief run a stage on a line token, unless the pipeline has failed.
+        *        (tokens in flight still pass through the remaining stages, so serial stages keep handing over to the tokens behind them)
+        *
+        * @param {Stage, in} stage
+        * @param {Line,  in} line
+        **/
+        void invoke(Stage& xi_stage, Line& xi_line) {
+            if (mFailed.load(std::memory_order_acquire)) {
+                return;
+            }
+
+            try {
+                xi_stage.mCallback(xi_line.mToken);
+            }
+            catch (...) {
+                fail(std::current_exception());
+            }
+        }
+
+        // a line has no more tokens to carry
+        void finishLine() {
+            if (mActiveLines.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mRunning = false;
+                mConditionVariable.notify_all();
+            }
+        }
+
+        // resume a line at a given stage on the executor
+        void submit(std::size_t xi_line, std::size_t xi_stage) {
+            mExecutor->submit([this, xi_line, xi_stage](std::size_t) { process(xi_line, xi_stage); });
+        }
+
+        /**
+        * \brief pass a line token through the stages (from a given stage), and keep producing new tokens on it
+        *        until it is either parked in a serial stage or the source is exhausted.
+        *
+        * @param {size_t, in} line
+        * @param {size_t, in} stage to start with
+        **/
+        void process(std::size_t xi_line, std::size_t xi_stage) {
+            const std::size_t lines{ mLines.size() };
+            Line& line = mLines[xi_line];
+
+            while (true) {
+                for (std::size_t s{ xi_stage }; s < mStages.size(); ++s) {
+                    Stage& stage = *mStages[s];
+
+                    if (stage.mMode == StageMode::Parallel) {
+                        invoke(stage, line);
+                        continue;
+                    }
+
+                    // wait for turn
+                    {
+                        std::unique_lock<std::mutex> lock(stage.mMutex);
+                        if (line.mSequence != stage.mNext) {
+                            stage.mParked[line.mSequence % lines] = xi_line;
+                            return;
+                        }
+                    }
+
+                    invoke(stage, line);
+
+                    // hand stage over to next token (if it is already waiting)
+                    std::size_t next{ NoLine };
+                    {
+                        std::unique_lock<std::mutex> lock(stage.mMutex);
+                        ++stage.mNext;
+                        std::swap(next, stage.mParked[stage.mNext % lines]);
+                    }
+
+                    if (next != NoLine) {
+                        submit(next, s);
+                    }
+                }
+
+                // token is done, reuse line (the source is not called once the pipeline has failed)
+                if (mFailed.load(std::memory_order_acquire) || !produce(xi_line)) {
+                    finishLine();
+                    return;
+                }
+                xi_stage = 0;
+            }
+        }
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {shared_ptr<Executor>, in} executor
+            * @param {size_t,               in} maximal amount of tokens in flight (at least one)
+            **/
+            Pipeline(std::shared_ptr<Executor> xi_executor, std::size_t xi_tokens) : mExecutor(std::move(xi_executor)), mLines(xi_tokens > 0 ? xi_tokens : 1),
+                                                                                     mProduced(0), mExhausted(false), mActiveLines(0), mRunning(false), mFailed(false) {
+                if (!mExecutor) {
+                    throw std::invalid_argument("pipeline requires an executor.");
+                }
+            }
+
+            // copy semantics
+            Pipeline(const Pipeline&) = delete;
+            Pipeline& operator=(const Pipeline&) = delete;
+
+            // move semantics
+            Pipeline(Pipeline&&) noexcept = delete;
+            Pipeline& operator=(Pipeline&&) noexcept = delete;
+
+            // return maximal amount of tokens in flight
+            std::size_t tokens() const { return mLines.size(); }
+
+            // return amount of stages
+            std::size_t size() const { return mStages.size(); }
+
+            /**
+            * \brief append a stage to pipeline
+            *
+            * @param {StageMode,            in}  stage execution mode
+            * @param {function<void(T&)>,   in}  stage callback (modifies token in place)
+            * @param {Pipeline,             out} this pipeline
+            **/
+            Pipeline& addStage(StageMode xi_mode, StageCallback xi_callback) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                if (mRunning) {
+                    throw std::logic_error("pipeline is being executed.");
+                }
+
+                auto stage = std::make_unique<Stage>();
+                stage->mCallback = std::move(xi_callback);
+                stage->mMode = xi_mode;
+                if (xi_mode == StageMode::SerialInOrder) {
+                    stage->mParked = std::make_unique<std::size_t[]>(mLines.size());
+                }
+                mStages.emplace_back(std::move(stage));
+                return *this;
+            }
+
+            /**
+            * \brief pass a stream of tokens through the pipeline and block until all of them went through all stages.
+            *        should not be called from a task running on the pipeline executor.
+            *        if a stage (or the source) throws, no new tokens are produced, tokens in flight skip the remaining stages
+            *        and the first exception is rethrown once all lines finished.
+            *
+            * @param {function<bool(T&)>, in}  source - called serially, fills a token and returns false once stream is exhausted
+            * @param {size_t,             out} amount of tokens which went through the pipeline
+            **/
+            std::size_t run(SourceCallback xi_source) {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    if (mRunning) {
+                        throw std::logic_error("pipeline is already being executed.");
+                    }
+                    mRunning = true;
+                }
+
+                const std::size_t lines{ mLines.size() };
+                mSource = std::move(xi_source);
+                mProduced = 0;
+                mExhausted = false;
+                mFailed.store(false, std::memory_order_relaxed);
+                for (auto& stage : mStages) {
+                    stage->mNext = 0;
+                    if (stage->mParked) {
+                        std::fill_n(stage->mParked.get(), lines, NoLine);
+                    }
+                }
+                mActiveLines.store(lines, std::memory_order_relaxed);
+
+                // every line produces its first token on the executor
+                for (std::size_t i{}; i < lines; ++i) {
+                    mExecutor->submit([this, i](std::size_t) {
+                        if (!mFailed.load(std::memory_order_acquire) && produce(i)) {
+                            process(i, 0);
+                        }
+                        else {
+                            finishLine();
+                        }
+                    });
+                }
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                mConditionVariable.wait(lock, [this] { return !mRunning; });
+                if (mException) {
+                    std::exception_ptr exception{ std::move(mException) };
+                    mException = nullptr;
+                    std::rethrow_exception(exception);
+                }
+                return mProduced;
+            }
+    };
+};
@@ -40,7 +40,7 @@ namespace BabyTask {
 
         // internal
         std::queue<T> mQueue;
-        std::mutex mMutex;
+        mutable std::mutex mMutex;
 
         // API
         public:
@@ -115,12 +115,46 @@ namespace BabyTask {
                 return true;
             }
 
+            /**
+            * \brief push (move) several elements to queue in one operation
+            *
+            * @param {T*,     in}  elements to be pushed
+            * @param {size_t, in}  amount of elements
+            * @param {size_t, out} amount of elements pushed
+            **/
+            std::size_t push_bulk(T* xi_elements, std::size_t xi_count) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                for (std::size_t i{}; i < xi_count; ++i) {
+                    mQueue.emplace(std::move(xi_elements[i]));
+                }
+
+                return xi_count;
+            }
+
+            /**
+            * \brief pop (move) several elements from queue in one operation
+            *
+            * @param {T*,     out} popped elements
+            * @param {size_t, in}  maximal amount of elements to pop
+            * @param {size_t, out} amount of elements popped
+            **/
+            std::size_t pop_bulk(T* xo_elements, std::size_t xi_count) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                std::size_t popped{};
+                while ((popped < xi_count) && !mQueue.empty()) {
+                    xo_elements[popped++] = std::move(mQueue.front());
+                    mQueue.pop();
+                }
+
+                return popped;
+            }
+
             /**
             * \brief test if queue is empty
             *
             * @param {bool, out} true if queue is empty
             **/
-            constexpr bool empty() const {
+            bool empty() const {
                 std::unique_lock<std::mutex> lock(mMutex);
                 return mQueue.empty();
             }
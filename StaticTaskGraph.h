@@ -0,0 +1,369 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "Executor.h"
+#include <array>
+#include <tuple>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <stdexcept>
+
+namespace BabyTask {
+
+    /**
+    * \brief a compile time edge - node 'To' is executed once node 'From' has finished
+    **/
+    template<std::size_t From, std::size_t To> struct Edge {
+        static constexpr std::size_t from = From;
+        static constexpr std::size_t to = To;
+    };
+
+    /**
+    * \brief compile time list of edges
+    **/
+    template<typename... E> struct Edges {};
+
+    /**
+    * \brief compile time topology of 'N' nodes: successors (CSR), pending counts, sources and a topological order.
+    *        a cycle or an edge to a node which does not exist fail compilation.
+    **/
+    template<std::size_t N, typename EdgeList> struct StaticTopology;
+
+    template<std::size_t N, typename... E>
+    struct StaticTopology<N, Edges<E...>> {
+        static constexpr std::size_t EdgeCount = sizeof...(E);
+        static constexpr std::array<std::size_t, EdgeCount> From{ { E::from... } };
+        static constexpr std::array<std::size_t, EdgeCount> To{ { E::to... } };
+
+        // edges refer to existing nodes
+        static constexpr bool valid = ((E::from < N) && ...) && ((E::to < N) && ...);
+        static_assert(valid, "static task graph edge refers to a node which does not exist.");
+
+        // amount of parents per node
+        static constexpr std::array<std::size_t, N> Pending = []() {
+            std::array<std::size_t, N> pending{};
+            for (std::size_t i{}; i < EdgeCount; ++i) {
+                ++pending[To[i]];
+            }
+            return pending;
+        }();
+
+        // successors of node i are Successors[Offsets[i], Offsets[i + 1])
+        static constexpr std::array<std::size_t, N + 1> Offsets = []() {
+            std::array<std::size_t, N + 1> offsets{};
+            for (std::size_t i{}; i < EdgeCount; ++i) {
+                ++offsets[From[i] + 1];
+            }
+            for (std::size_t i{}; i < N; ++i) {
+                offsets[i + 1] += offsets[i];
+            }
+            return offsets;
+        }();
+
+        static constexpr std::array<std::size_t, EdgeCount> Successors = []() {
+            std::array<std::size_t, EdgeCount> successors{};
+            std::array<std::size_t, N + 1> position{ Offsets };
+            for (std::size_t i{}; i < EdgeCount; ++i) {
+                successors[position[From[i]]++] = To[i];
+            }
+            return successors;
+        }();
+
+        // amount of sink nodes (nodes without successors)
+        static constexpr std::size_t SinkCount = []() {
+            std::size_t count{};
+            for (std::size_t i{}; i < N; ++i) {
+                count += (Offsets[i] == Offsets[i + 1]) ? 1 : 0;
+            }
+            return count;
+        }();
+
+        // amount of source nodes
+        static constexpr std::size_t SourceCount = []() {
+            std::size_t count{};
+            for (std::size_t i{}; i < N; ++i) {
+                count += (Pending[i] == 0) ? 1 : 0;
+            }
+            return count;
+        }();
+
+        // source nodes
+        static constexpr std::array<std::size_t, SourceCount> Sources = []() {
+            std::array<std::size_t, SourceCount> sources{};
+            std::size_t count{};
+            for (std::size_t i{}; i < N; ++i) {
+                if (Pending[i] == 0) {
+                    sources[count++] = i;
+                }
+            }
+            return sources;
+        }();
+
+        // topological order (Kahn), its size is less than N if graph has a cycle
+        struct Order {
+            std::array<std::size_t, N> mNodes{};
+            std::size_t mSize{};
+        };
+
+        static constexpr Order TopologicalOrder = []() {
+            Order order{};
+            std::array<std::size_t, N> pending{ Pending };
+            for (std::size_t i{}; i < SourceCount; ++i) {
+                order.mNodes[order.mSize++] = Sources[i];
+            }
+            for (std::size_t i{}; i < order.mSize; ++i) {
+                const std::size_t node{ order.mNodes[i] };
+                for (std::size_t j{ Offsets[node] }; j < Offsets[node + 1]; ++j) {
+                    if (--pending[Successors[j]] == 0) {
+                        order.mNodes[order.mSize++] = Successors[j];
+                    }
+                }
+            }
+            return order;
+        }();
+
+        static_assert(TopologicalOrder.mSize == N, "static task graph has a cycle.");
+    };
+
+    /**
+    * \brief task graph whose topology is known at compile time.
+    *        tasks are held by their concrete type (no type erasure), pending counts and successors are compile time
+    *        constants, and every node has its own instantiated dispatch function in which the task and the release of
+    *        its successors are inlined. nodes can be executed on an executor (in parallel) or sequentially in topological order.
+    *
+    * @param {EdgeList} graph edges ('Edges<Edge<from, to>...>')
+    * @param {Tasks...} node tasks (callable as 'void()')
+    **/
+    template<typename EdgeList, typename... Tasks>
+    class StaticTaskGraph {
+
+        // aliases
+        using Topology = StaticTopology<sizeof...(Tasks), EdgeList>;
+        using Dispatch = std::size_t (*)(StaticTaskGraph*);
+
+        // amount of nodes
+        static constexpr std::size_t N = sizeof...(Tasks);
+
+        // sentinel for 'no node'
+        static constexpr std::size_t NoNode = static_cast<std::size_t>(-1);
+
+        // properties
+        std::shared_ptr<Executor> mExecutor;
+        std::tuple<Tasks...> mTasks;
+        std::array<std::atomic<std::size_t>, N> mPending;
+        std::atomic<std::size_t> mRemaining;           // amount of sinks which have not finished yet
+        bool mRunning;                                  // guarded by mMutex
+        std::atomic<bool> mFailed;                      // a task of current execution has thrown (remaining tasks are skipped)
+        std::exception_ptr mException;                  // first exception thrown by a task of current execution (guarded by mMutex)
+        std::mutex mMutex;
+        std::condition_variable mConditionVariable;
+
+        // keep the first exception thrown by a task of current execution
+        void fail(std::exception_ptr xi_exception) {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (!mException) {
+                mException = std::move(xi_exception);
+            }
+            mFailed.store(true, std::memory_order_release);
+        }
+
+        // block until current execution (if any) is finished
+        void join() {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mConditionVariable.wait(lock, [this]() { return !mRunning; });
+        }
+
+        /**
+        * \brief execute node 'I', release its successors (ready ones are pushed to executor, except the last one).
+        *        a successor with a single parent is ready without touching its pending count, and only sinks
+        *        count down to graph completion (a sink finishes after all of its ancestors).
+        *        once a task has thrown, the remaining tasks are skipped (but still release their successors).
+        *
+        * @param {StaticTaskGraph, in}  graph
+        * @param {size_t,          out} successor which became ready last (to be executed by the calling thread)
+        **/
+        template<std::size_t I>
+        static std::size_t runNode(StaticTaskGraph* xi_graph) {
+            if (!xi_graph->mFailed.load(std::memory_order_acquire)) {
+                try {
+                    std::get<I>(xi_graph->mTasks)();
+                }
+                catch (...) {
+                    xi_graph->fail(std::current_exception());
+                }
+            }
+
+            if constexpr (Topology::Offsets[I] == Topology::Offsets[I + 1]) {
+                if (xi_graph->mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    std::unique_lock<std::mutex> lock(xi_graph->mMutex);
+                    xi_graph->mRunning = false;
+                    xi_graph->mConditionVariable.notify_all();
+                }
+                return NoNode;
+            }
+            else {
+                std::size_t next{ NoNode };
+                for (std::size_t j{ Topology::Offsets[I] }; j < Topology::Offsets[I + 1]; ++j) {
+                    const std::size_t successor{ Topology::Successors[j] };
+                    if ((Topology::Pending[successor] == 1) || (xi_graph->mPending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1)) {
+                        if (next != NoNode) {
+                            xi_graph->submit(next);
+                        }
+                        next = successor;
+                    }
+                }
+
+                return next;
+            }
+        }
+
+        // dispatch table (one instantiated function per node)
+        template<std::size_t... I>
+        static constexpr std::array<Dispatch, N> makeDispatch(std::index_sequence<I...>) {
+            return { { &runNode<I>... } };
+        }
+
+        // push a node to executor, it is followed by the successors which become ready on the same thread
+        void submit(std::size_t xi_node) {
+            mExecutor->submit([this, xi_node](std::size_t) {
+                static constexpr std::array<Dispatch, N> dispatch{ makeDispatch(std::make_index_sequence<N>{}) };
+                for (std::size_t node{ xi_node }; node != NoNode;) {
+                    node = dispatch[node](this);
+                }
+            });
+        }
+
+        // execute all tasks in topological order
+        template<std::size_t... I>
+        void runSequential(std::index_sequence<I...>) {
+            (std::get<Topology::TopologicalOrder.mNodes[I]>(mTasks)(), ...);
+        }
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {shared_ptr<Executor>, in} executor
+            * @param {Tasks...,             in} node tasks
+            **/
+            explicit StaticTaskGraph(std::shared_ptr<Executor> xi_executor, Tasks... xi_tasks) : mExecutor(std::move(xi_executor)), mTasks(std::move(xi_tasks)...), mRemaining(0), mRunning(false), mFailed(false) {
+                if (!mExecutor) {
+                    throw std::invalid_argument("task graph requires an executor.");
+                }
+            }
+
+            // destructor
+            ~StaticTaskGraph() noexcept { join(); }
+
+            // copy semantics
+            StaticTaskGraph(const StaticTaskGraph&) = delete;
+            StaticTaskGraph& operator=(const StaticTaskGraph&) = delete;
+
+            // move semantics
+            StaticTaskGraph(StaticTaskGraph&&) noexcept = delete;
+            StaticTaskGraph& operator=(StaticTaskGraph&&) noexcept = delete;
+
+            // return amount of nodes
+            static constexpr std::size_t size() { return N; }
+
+            // return node task
+            template<std::size_t I>
+            auto& getTask() { return std::get<I>(mTasks); }
+
+            /**
+            * \brief start executing graph on executor and return without waiting for it to finish
+            *        (throws if graph is already being executed)
+            **/
+            void executeAsync() {
+                {
+                    std::unique_lock<std::mutex> lock(mMutex);
+                    if (mRunning) {
+                        throw std::logic_error("task graph is already being executed.");
+                    }
+                    mRunning = (N > 0);
+                    mException = nullptr;
+                }
+                mFailed.store(false, std::memory_order_relaxed);
+
+                for (std::size_t i{}; i < N; ++i) {
+                    mPending[i].store(Topology::Pending[i], std::memory_order_relaxed);
+                }
+                mRemaining.store(Topology::SinkCount, std::memory_order_relaxed);
+
+                for (std::size_t source : Topology::Sources) {
+                    submit(source);
+                }
+            }
+
+            /**
+            * \brief execute graph on executor and wait for it to finish
+            *        (rethrows the first exception thrown by a task, the tasks which did not start by then are skipped)
+            **/
+            void execute() {
+                executeAsync();
+                wait();
+            }
+
+            /**
+            * \brief execute all tasks on calling thread (in topological order)
+            **/
+            void executeSequential() {
+                runSequential(std::make_index_sequence<N>{});
+            }
+
+            // block until current execution (if any) is finished, and rethrow the first exception thrown by its tasks
+            void wait() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mConditionVariable.wait(lock, [this]() { return !mRunning; });
+                if (mException) {
+                    std::exception_ptr exception{ std::move(mException) };
+                    mException = nullptr;
+                    std::rethrow_exception(exception);
+                }
+            }
+    };
+
+    /**
+    * \brief make a static task graph
+    *
+    * @param {EdgeList,             in}  graph edges ('Edges<Edge<from, to>...>')
+    * @param {shared_ptr<Executor>, in}  executor
+    * @param {Tasks...,             in}  node tasks (callable as 'void()')
+    * @param {StaticTaskGraph,      out} graph
+    **/
+    template<typename EdgeList, typename... Tasks>
+    StaticTaskGraph<EdgeList, std::decay_t<Tasks>...> makeStaticTaskGraph(std::shared_ptr<Executor> xi_executor, Tasks&&... xi_tasks) {
+        return StaticTaskGraph<EdgeList, std::decay_t<Tasks>...>(std::move(xi_executor), std::forward<Tasks>(xi_tasks)...);
+    }
+};
@@ -0,0 +1,200 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include "BaseTaskNode.h"
+#include "TaskNode.h"
+#include <memory>
+#include <type_traits>
+
+namespace BabyTask {
+
+    class TaskGraph;
+    template<typename TaskCallback> class SubflowNode;
+    template<typename TaskCallback> class ConditionNode;
+    class GraphNode;
+
+    /**
+    * \brief subflow builder - handed to a subflow node callable, which creates tasks and edges through it while it runs.
+    *        the tasks form a subgraph which is executed on the parent graph executor once the callable returns,
+    *        and the subflow node completes (releasing its descendants) only when the whole subgraph has completed.
+    *        (members are defined in TaskGraph.h, where TaskGraph is a complete type)
+    **/
+    class Subflow {
+
+        // properties
+        TaskGraph& mGraph;  // subgraph
+
+        // API
+        public:
+
+            explicit Subflow(TaskGraph& xi_graph) noexcept : mGraph(xi_graph) {}
+
+            // copy semantics
+            Subflow(const Subflow&) = delete;
+            Subflow& operator=(const Subflow&) = delete;
+
+            /**
+            * \brief make a task node in subgraph (see TaskGraph::makeTaskNode)
+            *
+            * @param {F,        in}  task
+            * @param {char*,    in}  node name
+            * @param {TaskNode, out} node
+            **/
+            template<typename F>
+            typename CallableTraits<std::decay_t<F>>::template NodeType<std::decay_t<F>>* makeTaskNode(F&& xi_task, const char* xi_name = "");
+
+            /**
+            * \brief make a nested subflow node in subgraph (see TaskGraph::makeSubflowNode)
+            *
+            * @param {F,           in}  task (callable as 'void(Subflow&)')
+            * @param {char*,       in}  node name
+            * @param {SubflowNode, out} node
+            **/
+            template<typename F>
+            SubflowNode<std::decay_t<F>>* makeSubflowNode(F&& xi_task, const char* xi_name = "");
+
+            /**
+            * \brief make a condition node in subgraph (see TaskGraph::makeConditionNode)
+            *
+            * @param {F,             in}  task (callable as 'integral()')
+            * @param {char*,         in}  node name
+            * @param {ConditionNode, out} node
+            **/
+            template<typename F>
+            ConditionNode<std::decay_t<F>>* makeConditionNode(F&& xi_task, const char* xi_name = "");
+
+            /**
+            * \brief make a node in subgraph which executes a prebuilt graph (see TaskGraph::makeGraphNode)
+            *
+            * @param {TaskGraph, in}  graph
+            * @param {char*,     in}  node name
+            * @param {GraphNode, out} node
+            **/
+            GraphNode* makeGraphNode(TaskGraph& xi_graph, const char* xi_name = "");
+
+            /**
+            * \brief connect a parent node result to a child node argument (see TaskGraph::connect)
+            *
+            * @param {size_t,     in} child argument index
+            * @param {ParentTask, in} parent node
+            * @param {ChildTask,  in} child node
+            **/
+            template<std::size_t ArgIndex, typename ParentTask, typename ChildTask>
+            void connect(ParentTask& xi_parent, ChildTask& xi_child);
+
+            // return subgraph (for any other node kind)
+            TaskGraph& graph() { return mGraph; }
+
+            // return amount of nodes created so far
+            std::size_t size() const;
+    };
+
+    /**
+    * \brief a node whose callable ('void(Subflow&)') builds a subgraph at runtime (i.e. - once it knows its fan out).
+    *        node descendants start only once the subgraph has completed.
+    *
+    * @param {TaskCallback} callable type
+    **/
+    template<typename TaskCallback>
+    class SubflowNode : public BaseTaskNode {
+        static_assert(std::is_invocable_v<TaskCallback&, Subflow&>, "subflow node callable must be invocable as 'void(Subflow&)'.");
+
+        // friends
+        friend class TaskGraph;
+
+        // properties
+        TaskCallback mCallback;                 // subgraph builder
+        std::unique_ptr<TaskGraph> mSubgraph;   // subgraph (cleared and rebuilt on every execution)
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {TaskGraph*,      in} graph
+            * @param {TaskCallback,    in} callable
+            * @param {string_view,     in} node name
+            * @param {memory_resource, in} graph arena
+            **/
+            SubflowNode(TaskGraph* xi_graph, TaskCallback xi_callback, std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                BaseTaskNode(xi_graph, xi_name, xi_resource), mCallback(std::move(xi_callback)) {}
+
+            /**
+            * \brief build subgraph and start it (defined in TaskGraph.h)
+            *
+            * @param {bool, out} true if subgraph is empty (node is complete)
+            **/
+            virtual bool execute() override;
+
+            // return subgraph built by last execution (null before first execution)
+            TaskGraph* getSubgraph() const { return mSubgraph.get(); }
+
+            // BaseTaskNode interface
+            virtual void reset() override {}
+    };
+
+    /**
+    * \brief a node which executes a prebuilt graph (on that graph executor), its descendants start once that graph has completed.
+    *        the nested graph must outlive the node and must not be executed elsewhere while the node runs.
+    **/
+    class GraphNode : public BaseTaskNode {
+
+        // friends
+        friend class TaskGraph;
+
+        // properties
+        TaskGraph* mNested;     // executed graph
+
+        // API
+        public:
+
+            /**
+            * \brief constructor
+            *
+            * @param {TaskGraph*,      in} graph
+            * @param {TaskGraph*,      in} executed graph
+            * @param {string_view,     in} node name
+            * @param {memory_resource, in} graph arena
+            **/
+            GraphNode(TaskGraph* xi_graph, TaskGraph* xi_nested, std::string_view xi_name, std::pmr::memory_resource* xi_resource) :
+                BaseTaskNode(xi_graph, xi_name, xi_resource), mNested(xi_nested) {}
+
+            /**
+            * \brief start executed graph (defined in TaskGraph.h)
+            *
+            * @param {bool, out} true if executed graph is empty (node is complete)
+            **/
+            virtual bool execute() override;
+
+            // return executed graph
+            TaskGraph& getGraph() const { return *mNested; }
+
+            // BaseTaskNode interface
+            virtual void reset() override {}
+    };
+};
@@ -0,0 +1,248 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <type_traits>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace BabyTask {
+
+    /**
+    * \brief move only 'void(std::size_t id)' callable with small buffer optimization
+    *        (callables which do not fit in the buffer are held on the heap).
+    **/
+    class Task {
+
+        // small buffer size (in bytes)
+        static constexpr std::size_t BufferSize = 6 * sizeof(void*);
+
+        // callable type specific operations
+        struct Operations {
+            void (*mInvoke)(void* xi_callable, std::size_t xi_id);
+            void (*mMove)(void* xo_to, void* xi_from) noexcept;    // move construct callable at 'xo_to' and destroy the one at 'xi_from'
+            void (*mDestroy)(void* xi_callable) noexcept;
+        };
+
+        // callable held in the small buffer
+        template<typename F> struct Inline {
+            static void invoke(void* xi_callable, std::size_t xi_id) { (*static_cast<F*>(xi_callable))(xi_id); }
+            static void move(void* xo_to, void* xi_from) noexcept {
+                ::new (xo_to) F(std::move(*static_cast<F*>(xi_from)));
+                static_cast<F*>(xi_from)->~F();
+            }
+            static void destroy(void* xi_callable) noexcept { static_cast<F*>(xi_callable)->~F(); }
+            static constexpr Operations operations{ &invoke, &move, &destroy };
+        };
+
+        // callable held on the heap (the small buffer holds its pointer)
+        template<typename F> struct Heap {
+            static void invoke(void* xi_callable, std::size_t xi_id) { (**static_cast<F**>(xi_callable))(xi_id); }
+            static void move(void* xo_to, void* xi_from) noexcept { *static_cast<F**>(xo_to) = *static_cast<F**>(xi_from); }
+            static void destroy(void* xi_callable) noexcept { delete *static_cast<F**>(xi_callable); }
+            static constexpr Operations operations{ &invoke, &move, &destroy };
+        };
+
+        // properties
+        alignas(std::max_align_t) unsigned char mBuffer[BufferSize];
+        const Operations* mOperations;
+
+        // API
+        public:
+
+            // default constructor (empty task)
+            Task() noexcept : mOperations(nullptr) {}
+
+            // construct from callable
+            template<typename F, typename D = std::decay_t<F>, typename std::enable_if<!std::is_same<D, Task>::value>::type* = nullptr>
+            Task(F&& xi_callable) : mOperations(nullptr) {
+                emplace(std::forward<F>(xi_callable));
+            }
+
+            // destructor
+            ~Task() noexcept { reset(); }
+
+            // copy semantics
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+
+            // move semantics
+            Task(Task&& xi_other) noexcept : mOperations(xi_other.mOperations) {
+                if (mOperations) {
+                    mOperations->mMove(mBuffer, xi_other.mBuffer);
+                    xi_other.mOperations = nullptr;
+                }
+            }
+
+            Task& operator=(Task&& xi_other) noexcept {
+                if (this != &xi_other) {
+                    reset();
+                    if (xi_other.mOperations) {
+                        xi_other.mOperations->mMove(mBuffer, xi_other.mBuffer);
+                        mOperations = xi_other.mOperations;
+                        xi_other.mOperations = nullptr;
+                    }
+                }
+                return *this;
+            }
+
+            /**
+            * \brief replace held callable
+            *
+            * @param {F, in} callable with 'void(std::size_t)' signature
+            **/
+            template<typename F>
+            void emplace(F&& xi_callable) {
+                using D = std::decay_t<F>;
+                reset();
+
+                if constexpr ((sizeof(D) <= BufferSize) && (alignof(D) <= alignof(std::max_align_t)) && std::is_nothrow_move_constructible<D>::value) {
+                    ::new (static_cast<void*>(mBuffer)) D(std::forward<F>(xi_callable));
+                    mOperations = &Inline<D>::operations;
+                }
+                else {
+                    *reinterpret_cast<D**>(mBuffer) = new D(std::forward<F>(xi_callable));
+                    mOperations = &Heap<D>::operations;
+                }
+            }
+
+            // destroy held callable
+            void reset() noexcept {
+                if (mOperations) {
+                    mOperations->mDestroy(mBuffer);
+                    mOperations = nullptr;
+                }
+            }
+
+            // test if a callable is held
+            explicit operator bool() const noexcept { return mOperations != nullptr; }
+
+            // invoke held callable
+            void operator()(std::size_t xi_id) { mOperations->mInvoke(mBuffer, xi_id); }
+    };
+
+    class TaskCache;
+
+    /**
+    * \brief a recycled task (queues pass pointers to slots, so pushing a task never moves it)
+    **/
+    struct TaskSlot {
+        Task mTask;
+        TaskSlot* mNext{};      // next slot in free list
+        TaskCache* mOwner{};    // cache which allocated this slot
+    };
+
+    /**
+    * \brief pool of recycled task slots.
+    *        only the owner thread allocates (and releases to the local free list),
+    *        other threads return slots through a lock free 'remote' free list.
+    **/
+    class TaskCache {
+
+        // slots are allocated in blocks
+        static constexpr std::size_t BlockSize = 64;
+
+        // properties
+        TaskSlot* mFree;                                    // local free list
+        std::atomic<TaskSlot*> mRemoteFree;                 // slots released by other threads
+        std::vector<std::unique_ptr<TaskSlot[]>> mBlocks;   // slot storage
+
+        // add a block of slots to the local free list
+        void grow() {
+            mBlocks.emplace_back(new TaskSlot[BlockSize]);
+            TaskSlot* block{ mBlocks.back().get() };
+            for (std::size_t i{}; i < BlockSize; ++i) {
+                block[i].mOwner = this;
+                block[i].mNext = (i + 1 < BlockSize) ? &block[i + 1] : mFree;
+            }
+            mFree = block;
+        }
+
+        // API
+        public:
+
+            // constructor (starts with one block, so bursts of up to 'BlockSize' tasks never allocate)
+            TaskCache() : mFree(nullptr), mRemoteFree(nullptr) {
+                grow();
+            }
+
+            // copy semantics
+            TaskCache(const TaskCache&) = delete;
+            TaskCache& operator=(const TaskCache&) = delete;
+
+            // move semantics
+            TaskCache(TaskCache&&) noexcept = delete;
+            TaskCache& operator=(TaskCache&&) noexcept = delete;
+
+            /**
+            * \brief allocate a slot (owner thread only)
+            *
+            * @param {F,        in}  task callable
+            * @param {TaskSlot, out} slot holding the task
+            **/
+            template<typename F>
+            TaskSlot* allocate(F&& xi_task) {
+                if (!mFree) {
+                    mFree = mRemoteFree.exchange(nullptr, std::memory_order_acquire);
+                }
+
+                if (!mFree) {
+                    grow();
+                }
+
+                TaskSlot* slot{ mFree };
+                mFree = slot->mNext;
+                slot->mTask.emplace(std::forward<F>(xi_task));
+                return slot;
+            }
+
+            /**
+            * \brief destroy slot task and return the slot to the cache which allocated it
+            *
+            * @param {TaskSlot,  in} slot
+            * @param {TaskCache, in} cache of the calling thread (null if it has none)
+            **/
+            static void release(TaskSlot* xi_slot, const TaskCache* xi_current) noexcept {
+                xi_slot->mTask.reset();
+                TaskCache* owner{ xi_slot->mOwner };
+
+                if (owner == xi_current) {
+                    xi_slot->mNext = owner->mFree;
+                    owner->mFree = xi_slot;
+                    return;
+                }
+
+                TaskSlot* head{ owner->mRemoteFree.load(std::memory_order_relaxed) };
+                do {
+                    xi_slot->mNext = head;
+                } while (!owner->mRemoteFree.compare_exchange_weak(head, xi_slot, std::memory_order_release, std::memory_order_relaxed));
+            }
+    };
+};
\ No newline at end of file
@@ -25,10 +25,22 @@
 **/
 #pragma once
 
-#include "ThreadPool.h"
+#include "Executor.h"
 #include "TaskNode.h"
-#include <list>
-#include <unordered_map>
+#include "ParallelTaskNode.h"
+#include "SubflowNode.h"
+#include "ConditionNode.h"
+#include "Cancellation.h"
+#include "Trace.h"
+#include <unordered_set>
+#include <memory_resource>
+#include <string_view>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <exception>
 
 namespace BabyTask {
 
@@ -37,124 +49,1583 @@ namespace BabyTask {
     **/
     class TaskGraph {
 
+        // friends
+        friend class BaseTaskNode;
+        template<typename Index> friend class ParallelTaskNode;
+        template<typename TaskCallback> friend class SubflowNode;
+        friend class GraphNode;
+
+        // aliases
+        using NodeIndex = std::uint32_t;
+
+        // sentinel for 'no node'
+        static constexpr NodeIndex NoNode = static_cast<NodeIndex>(-1);
+
+        // node which will be executed inline once the node running on current thread is done
+        struct Continuation {
+            const TaskGraph* mGraph{};  // graph whose node is running on current thread
+            NodeIndex mNode{ NoNode };  // last descendant which became ready
+        };
+
         // properties
-        ThreadPool mPool;                                   // thread pool
-        std::list<std::unique_ptr<BaseTaskNode>> mNodes;    // tasks
-        std::size_t mCompletedTasks{};                      // number of finished tasks
+        std::shared_ptr<Executor> mExecutor;                // executor (possibly shared with other graphs)
+        std::pmr::monotonic_buffer_resource mArena;         // nodes, their descendant lists and names
+        std::pmr::unordered_set<std::string_view> mNames;   // interned node names (characters are held in arena)
+        std::vector<BaseTaskNode*> mNodes;                  // tasks (indexed by BaseTaskNode::mIndex)
+        std::atomic<std::size_t> mRemaining{};              // number of nodes which have not finished yet (in current execution)
+        bool mRunning{};                                    // true while graph is being executed (guarded by mMutex)
+        TaskGraph* mParentGraph{};                          // graph whose node runs this graph (in current execution, null if none)
+        NodeIndex mParentNode{ NoNode };                    // node of parent graph which is completed once this graph has finished
+        std::shared_ptr<std::atomic<bool>> mCancelled;      // cancellation flag of current execution token (null if none)
+        Deadline mDeadline{ NoDeadline };                   // current execution deadline
+        std::atomic<ExecutionStatus> mStatus{ ExecutionStatus::Completed }; // current (or last) execution status
+        std::exception_ptr mException;                      // first exception thrown by a task in current (or last) execution (guarded by mMutex)
+        std::size_t mMaxInlineDepth{ 64 };                  // maximal amount of successive nodes executed inline by a single pool task
+        bool mPriorityScheduling{};                         // dispatch ready nodes by their upward rank (critical path first)
+        std::vector<float> mRanks;                          // upward rank per node - its cost plus the longest remaining path after it
+        std::vector<NodeIndex> mReady;                      // ready nodes waiting for a pool worker (max heap by rank, priority scheduling only)
+        std::mutex mReadyMutex;                             // guards mReady
         std::mutex mMutex;
         std::condition_variable mConditionVariable;
 
+        // compiled topology (flat arrays built by 'compile', indexed by BaseTaskNode::mIndex)
+        bool mCompiled{};                                   // true if topology arrays reflect graph structure
+        std::vector<NodeIndex> mSuccessorOffsets;           // successors of node i are mSuccessors[mSuccessorOffsets[i], mSuccessorOffsets[i + 1])
+        std::vector<NodeIndex> mSuccessors;                 // successor indices (CSR)
+        std::vector<NodeIndex> mInitialPending;             // amount of parents (and arguments) per node
+        std::unique_ptr<std::atomic<NodeIndex>[]> mPending; // amount of parents per node which have not finished yet (during execution)
+        std::vector<NodeIndex> mLevelOffsets;               // nodes at topological level l are mLevels[mLevelOffsets[l], mLevelOffsets[l + 1])
+        std::vector<NodeIndex> mLevels;                     // nodes sorted by topological level (level 0 are the source nodes)
+        bool mHasConditions{};                              // true if graph has condition nodes (so some nodes might be skipped)
+        std::unique_ptr<std::atomic<NodeIndex>[]> mLive;    // amount of live incoming edges per node (during execution, graphs with condition nodes only)
+        std::vector<NodeIndex> mPredecessorOffsets;         // parents of node i are mPredecessors[mPredecessorOffsets[i], mPredecessorOffsets[i + 1])
+        std::vector<NodeIndex> mPredecessors;               // parent indices (CSR)
+
+        // incremental execution
+        bool mIncremental{};                                // true once graph was executed incrementally (nodes keep their results)
+        bool mPartial{};                                    // true if current execution runs only the nodes stamped with mRunEpoch
+        std::vector<NodeIndex> mDirtyNodes;                 // nodes marked dirty since last incremental execution
+        std::vector<NodeIndex> mRunNodes;                   // nodes executed by last incremental execution
+        std::vector<std::uint32_t> mRunStamp;               // per node, epoch of the last incremental execution which runs it
+        std::vector<std::uint32_t> mDeliverStamp;           // per node, epoch of the last incremental execution which redelivered its result
+        std::uint32_t mRunEpoch{};                          // current incremental execution epoch
+
+        // cycle checking (a topological order which is kept valid as edges are declared)
+        bool mCycleChecking{};                              // true if an edge which closes a cycle is rejected when declared
+        std::vector<NodeIndex> mOrder;                      // position of node i in topological order
+        std::vector<NodeIndex> mOrdered;                    // node at position p in topological order
+        std::vector<std::uint32_t> mVisitStamp;             // per node, epoch of the last search which reached it
+        std::uint32_t mVisitEpoch{};                        // current search epoch
+        std::vector<NodeIndex> mSearch;                     // search stack (and reordering buffer)
+
+#ifdef BABYTASK_TRACING
+        // node timestamps in current execution (in tracer ticks)
+        std::unique_ptr<std::uint64_t[]> mTraceReady;
+        std::unique_ptr<std::uint64_t[]> mTraceStart;
+        std::unique_ptr<std::uint64_t[]> mTraceEnd;
+
+        // record a finished node
+        void traceNode(NodeIndex xi_node, std::size_t xi_worker) {
+            mTraceEnd[xi_node] = Tracer::now();
+            Tracer::instance().record(TraceEvent{ mNodes[xi_node]->getName(), mTraceReady[xi_node], mTraceStart[xi_node], mTraceEnd[xi_node], static_cast<std::uint32_t>(xi_worker) });
+        }
+#endif
+
+        // return continuation of current thread
+        static Continuation& currentContinuation() {
+            static thread_local Continuation continuation;
+            return continuation;
+        }
+
+        /**
+        * \brief execute a node and then - in a loop (so the stack does not grow) - the descendant
+        *        which became ready last, until no descendant is ready or the inline depth cap is reached
+        *
+        * @param {NodeIndex, in} node to be executed
+        * @param {size_t,    in} pool worker id
+        **/
+        void runNode(NodeIndex xi_node, [[maybe_unused]] std::size_t xi_worker) {
+            // restore outer continuation (a node might execute another graph) even if an exception occurred
+            struct Scope {
+                Continuation& mContinuation;
+                const Continuation mOuter;
+                ~Scope() { mContinuation = mOuter; }
+            } scope{ currentContinuation(), currentContinuation() };
+
+            Continuation& continuation = scope.mContinuation;
+            continuation.mGraph = this;
+            std::size_t depth{};
+
+            while (xi_node != NoNode) {
+                continuation.mNode = NoNode;
+                BABYTASK_TRACE(mTraceStart[xi_node] = Tracer::now());
+
+                if (shouldStop()) {
+                    skipNode(xi_node, xi_worker);
+                }
+                else if (executeNode(xi_node, xi_worker)) {
+                    BABYTASK_TRACE(traceNode(xi_node, xi_worker));
+                    releaseSuccessors(xi_node);
+                    onNodeCompleted(xi_worker);
+                }
+
+                // notice that graph might already be destroyed if there is no continuation
+                xi_node = continuation.mNode;
+                if ((xi_node != NoNode) && (++depth > mMaxInlineDepth)) {
+                    submitNode(xi_node);
+                    xi_node = NoNode;
+                }
+            }
+        }
+
+        /**
+        * \brief test if current execution should stop - its token was cancelled or its deadline has passed
+        *        (the first to notice sets execution status, which then stays as is until the execution is finished)
+        *
+        * @param {bool, out} true if execution should stop
+        **/
+        bool shouldStop() {
+            if (mStatus.load(std::memory_order_relaxed) != ExecutionStatus::Completed) {
+                return true;
+            }
+
+            if (mCancelled && mCancelled->load(std::memory_order_acquire)) {
+                stop(ExecutionStatus::Cancelled);
+                return true;
+            }
+
+            if ((mDeadline != NoDeadline) && (std::chrono::steady_clock::now() >= mDeadline)) {
+                stop(ExecutionStatus::DeadlineExceeded);
+                return true;
+            }
+
+            return false;
+        }
+
+        /**
+        * \brief skip a node of a stopped execution, along with every descendant it was the last pending parent of
+        *        (they are counted as completed without being scheduled)
+        *
+        * @param {NodeIndex, in} node to be skipped
+        * @param {size_t,    in} pool worker id
+        **/
+        void skipNode(NodeIndex xi_node, std::size_t xi_worker) {
+            static thread_local std::vector<NodeIndex> skipped;
+            const std::size_t bottom{ skipped.size() };
+            std::size_t skippedCount{};
+
+            NodeIndex node{ xi_node };
+            while (true) {
+                for (NodeIndex i{ mSuccessorOffsets[node] }; i < mSuccessorOffsets[node + 1]; ++i) {
+                    const NodeIndex successor{ mSuccessors[i] };
+                    if (mPartial && (mRunStamp[successor] != mRunEpoch)) {
+                        continue;
+                    }
+
+                    if (mPending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        skipped.push_back(successor);
+                    }
+                }
+
+                if (skipped.size() == bottom) {
+                    break;
+                }
+
+                node = skipped.back();
+                skipped.pop_back();
+                ++skippedCount;
+            }
+
+            // the skipped node itself is counted last (it might complete the graph)
+            if (skippedCount > 0) {
+                mRemaining.fetch_sub(skippedCount, std::memory_order_acq_rel);
+            }
+            onNodeCompleted(xi_worker);
+        }
+
+        // keep the first exception thrown by a task of current execution, and stop it
+        void fail(std::exception_ptr xi_exception) {
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                if (!mException) {
+                    mException = std::move(xi_exception);
+                }
+            }
+            mStatus.store(ExecutionStatus::Failed, std::memory_order_relaxed);
+        }
+
+        // rethrow the exception a task of last execution has thrown (if any)
+        void rethrow() {
+            std::unique_lock<std::mutex> lock(mMutex);
+            if (mException) {
+                std::rethrow_exception(mException);
+            }
+        }
+
+        // set execution status (unless it is already set)
+        void stop(ExecutionStatus xi_status) {
+            ExecutionStatus expected{ ExecutionStatus::Completed };
+            mStatus.compare_exchange_strong(expected, xi_status, std::memory_order_relaxed);
+        }
+
+        /**
+        * \brief execute node task (measuring its duration when scheduling by priority).
+        *        a task which throws fails the execution - its exception is kept and the node is skipped.
+        *
+        * @param {NodeIndex, in}  node to be executed
+        * @param {size_t,    in}  pool worker id
+        * @param {bool,      out} false if node task continues elsewhere (or has thrown)
+        **/
+        bool executeNode(NodeIndex xi_node, std::size_t xi_worker) {
+            BaseTaskNode* node{ mNodes[xi_node] };
+            const auto start = mPriorityScheduling ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+            bool failed{};
+            try {
+                if (!node->execute()) {
+                    return false;
+                }
+            }
+            catch (...) {
+                fail(std::current_exception());
+                failed = true;
+            }
+
+            // skipped once the exception is released by this thread (skipping might finish the execution)
+            if (failed) {
+                skipNode(xi_node, xi_worker);
+                return false;
+            }
+
+            if (!mPriorityScheduling) {
+                return true;
+            }
+
+            const float duration{ std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count() };
+            node->mMeasuredCost = (node->mMeasuredCost < 0.0f) ? duration : 0.5f * (node->mMeasuredCost + duration);
+            return true;
+        }
+
+        // push a node to thread pool, preferring workers of its NUMA node
+        // (when scheduling by priority, the pool task runs the highest ranked ready node and locality is not used)
+        void submitNode(NodeIndex xi_node) {
+            if (!mPriorityScheduling) {
+                mExecutor->submit([this, xi_node](std::size_t id) { runNode(xi_node, id); }, mNodes[xi_node]->mLocality);
+                return;
+            }
+
+            {
+                std::unique_lock<std::mutex> lock(mReadyMutex);
+                mReady.push_back(xi_node);
+                std::push_heap(mReady.begin(), mReady.end(), [this](NodeIndex a, NodeIndex b) { return mRanks[a] < mRanks[b]; });
+            }
+            mExecutor->submit([this](std::size_t id) { runNode(popReady(), id); });
+        }
+
+        // remove and return highest ranked ready node
+        NodeIndex popReady() {
+            std::unique_lock<std::mutex> lock(mReadyMutex);
+            std::pop_heap(mReady.begin(), mReady.end(), [this](NodeIndex a, NodeIndex b) { return mRanks[a] < mRanks[b]; });
+            const NodeIndex node{ mReady.back() };
+            mReady.pop_back();
+            return node;
+        }
+
+        // compute upward rank of every node (in reverse topological order)
+        void computeRanks() {
+            const std::size_t count{ mNodes.size() };
+            mRanks.resize(count);
+
+            for (std::size_t i{ count }; i > 0; --i) {
+                const NodeIndex node{ mLevels[i - 1] };
+                float longest{};
+                for (NodeIndex j{ mSuccessorOffsets[node] }; j < mSuccessorOffsets[node + 1]; ++j) {
+                    longest = std::max(longest, mRanks[mSuccessors[j]]);
+                }
+
+                const BaseTaskNode* base{ mNodes[node] };
+                const float cost{ (base->mCost >= 0.0f) ? base->mCost : ((base->mMeasuredCost >= 0.0f) ? base->mMeasuredCost : 1.0f) };
+                mRanks[node] = cost + longest;
+            }
+        }
+
+        /**
+        * \brief decrement the pending count of node successors and schedule those which became ready
+        *        (in reverse order, so the first declared successor is the one kept as continuation)
+        *
+        * @param {NodeIndex, in} node which has finished
+        **/
+        void releaseSuccessors(NodeIndex xi_node) {
+            if (mHasConditions) {
+                releaseBranches(xi_node);
+                return;
+            }
+
+            const NodeIndex first{ mSuccessorOffsets[xi_node] };
+            for (NodeIndex i{ mSuccessorOffsets[xi_node + 1] }; i > first; --i) {
+                const NodeIndex successor{ mSuccessors[i - 1] };
+                if (mPartial && (mRunStamp[successor] != mRunEpoch)) {
+                    continue;
+                }
+
+                if (mPending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    BABYTASK_TRACE(mTraceReady[successor] = mTraceEnd[xi_node]);
+                    scheduleNode(successor);
+                }
+            }
+        }
+
+        /**
+        * \brief release successors in a graph with condition nodes. an edge is live if its parent ran and (for a condition node)
+        *        it leads to the chosen branch. a node whose parents have all finished runs if any of its incoming edges is live,
+        *        otherwise it is skipped: it counts as completed and its successors are released (through dead edges) right away,
+        *        so it is never scheduled.
+        *
+        * @param {NodeIndex, in} node which has finished
+        **/
+        void releaseBranches(NodeIndex xi_node) {
+            static thread_local std::vector<NodeIndex> skipped;
+            const std::size_t bottom{ skipped.size() };
+            std::size_t skippedCount{};
+
+            NodeIndex node{ xi_node };
+            bool ran{ true };
+            while (true) {
+                const BaseTaskNode* base{ mNodes[node] };
+                const NodeIndex first{ mSuccessorOffsets[node] };
+                for (NodeIndex i{ mSuccessorOffsets[node + 1] }; i > first; --i) {
+                    const NodeIndex successor{ mSuccessors[i - 1] };
+                    if (ran && (!base->mCondition || (base->mBranch == i - 1 - first))) {
+                        mLive[successor].fetch_add(1, std::memory_order_relaxed);
+                    }
+
+                    if (mPending[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        if (mLive[successor].load(std::memory_order_relaxed) > 0) {
+                            BABYTASK_TRACE(mTraceReady[successor] = mTraceEnd[xi_node]);
+                            scheduleNode(successor);
+                        }
+                        else {
+                            skipped.push_back(successor);
+                        }
+                    }
+                }
+
+                if (skipped.size() == bottom) {
+                    break;
+                }
+
+                node = skipped.back();
+                skipped.pop_back();
+                ran = false;
+                ++skippedCount;
+            }
+
+            // the node which has finished is not counted yet, so this never completes the graph
+            if (skippedCount > 0) {
+                mRemaining.fetch_sub(skippedCount, std::memory_order_acq_rel);
+            }
+        }
+
+        /**
+        * \brief schedule a ready node. when called from within a node of this graph, the node which
+        *        became ready last is kept as the current thread continuation and the others are pushed to the pool.
+        *        a node hinted to another NUMA node than the current worker one is always pushed to the pool.
+        *
+        * @param {NodeIndex, in} node to be executed
+        **/
+        void scheduleNode(NodeIndex xi_node) {
+            Continuation& continuation = currentContinuation();
+            const std::size_t locality{ mNodes[xi_node]->mLocality };
+            if ((continuation.mGraph != this) || (mMaxInlineDepth == 0) ||
+                ((locality != AnyNode) && (locality < mExecutor->nodeCount()) && (mExecutor->currentNode() != locality))) {
+                submitNode(xi_node);
+                return;
+            }
+
+            if (continuation.mNode != NoNode) {
+                // when scheduling by priority, the higher ranked node is kept
+                if (mPriorityScheduling && (mRanks[xi_node] < mRanks[continuation.mNode])) {
+                    submitNode(xi_node);
+                    return;
+                }
+                submitNode(continuation.mNode);
+            }
+            continuation.mNode = xi_node;
+        }
+
+        /**
+        * \brief complete a node whose task continued outside of 'runNode' (i.e. - a parallel node),
+        *        the descendant which became ready last is executed inline
+        *
+        * @param {NodeIndex, in} node which has finished
+        * @param {size_t,    in} pool worker id
+        **/
+        void completeNode(NodeIndex xi_node, [[maybe_unused]] std::size_t xi_worker) {
+            Continuation& continuation = currentContinuation();
+            const Continuation outer{ continuation };
+            continuation = Continuation{ this, NoNode };
+
+            BABYTASK_TRACE(traceNode(xi_node, xi_worker));
+            releaseSuccessors(xi_node);
+            onNodeCompleted(xi_worker);
+
+            const NodeIndex next{ continuation.mNode };
+            continuation = outer;
+            if (next != NoNode) {
+                runNode(next, xi_worker);
+            }
+        }
+
+        /**
+        * \brief callback to be executed when single node is completed (the last one wakes up the waiters,
+        *        and completes the parent graph node when this graph runs as a node of another graph)
+        *
+        * @param {size_t, in} pool worker id
+        **/
+        void onNodeCompleted(std::size_t xi_worker) {
+            if (mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                TaskGraph* parent{ mParentGraph };
+                const NodeIndex node{ mParentNode };
+                finish();
+
+                // notice that this graph might already be destroyed
+                if (parent) {
+                    parent->completeNode(node, xi_worker);
+                }
+            }
+        }
+
+        // end current execution - pass an exception (or a stopped status) on to parent graph and wake up the waiters
+        void finish() {
+            if (mParentGraph && (mStatus.load(std::memory_order_relaxed) != ExecutionStatus::Completed)) {
+                if (mException) {
+                    mParentGraph->fail(mException);
+                }
+                else {
+                    mParentGraph->stop(mStatus.load(std::memory_order_relaxed));
+                }
+            }
+
+            std::unique_lock<std::mutex> lock(mMutex);
+            mRunning = false;
+            mConditionVariable.notify_all();
+        }
+
+        /**
+        * \brief start executing graph (compiles graph first if its structure has changed). throws if graph is already being executed.
+        *        a graph which runs as a node of another graph shares its cancellation token and deadline.
+        *
+        * @param {TaskGraph*, in}  graph whose node runs this graph (null if none)
+        * @param {NodeIndex,  in}  node of parent graph to complete once this graph has finished
+        * @param {bool,       in}  true to execute only the nodes in 'mRunNodes' (which are stamped with mRunEpoch)
+        * @param {shared_ptr, in}  cancellation flag (null if execution can not be cancelled)
+        * @param {Deadline,   in}  execution deadline
+        * @param {bool,       out} false if execution is already finished (nothing was started, or it was finished before this returned)
+        **/
+        bool launch(TaskGraph* xi_parent, NodeIndex xi_node, bool xi_partial = false,
+                    std::shared_ptr<std::atomic<bool>> xi_cancelled = nullptr, Deadline xi_deadline = NoDeadline) {
+            if (!mCompiled) {
+                compile();
+            }
+
+            if (xi_parent) {
+                xi_cancelled = xi_parent->mCancelled;
+                xi_deadline = xi_parent->mDeadline;
+            }
+
+            const std::size_t count{ xi_partial ? mRunNodes.size() : mNodes.size() };
+            bool stopped{};
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                if (mRunning) {
+                    throw std::logic_error("task graph is already being executed.");
+                }
+                mParentGraph = xi_parent;
+                mParentNode = xi_node;
+                mPartial = xi_partial;
+                mCancelled = std::move(xi_cancelled);
+                mDeadline = xi_deadline;
+                mStatus.store(ExecutionStatus::Completed, std::memory_order_relaxed);
+                mException = nullptr;
+                stopped = shouldStop();
+                mRunning = (count > 0) && !stopped;
+            }
+
+            if (stopped && xi_parent) {
+                xi_parent->stop(mStatus.load(std::memory_order_relaxed));
+            }
+
+            if ((count == 0) || stopped) {
+                return false;
+            }
+
+            // reset pending counts (relaxed stores of a flat array, i.e. - a bulk copy), in a partial execution
+            // only parents which are executed as well are counted
+            if (xi_partial) {
+                for (NodeIndex node : mRunNodes) {
+                    mPending[node].store(0, std::memory_order_relaxed);
+                }
+                for (NodeIndex node : mRunNodes) {
+                    for (NodeIndex j{ mSuccessorOffsets[node] }; j < mSuccessorOffsets[node + 1]; ++j) {
+                        const NodeIndex successor{ mSuccessors[j] };
+                        if (mRunStamp[successor] == mRunEpoch) {
+                            mPending[successor].store(mPending[successor].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            }
+            else {
+                for (std::size_t i{}; i < count; ++i) {
+                    mPending[i].store(mInitialPending[i], std::memory_order_relaxed);
+                }
+            }
+            // launch holds one count of its own, so the execution can not finish (and this graph, or its executor,
+            // be destroyed by a waiter) before all source nodes are submitted
+            mRemaining.store(count + 1, std::memory_order_relaxed);
+
+            if (mHasConditions) {
+                for (std::size_t i{}; i < count; ++i) {
+                    mLive[i].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            if (mPriorityScheduling) {
+                computeRanks();
+                mReady.reserve(count);
+            }
+
+            // source nodes
+            BABYTASK_TRACE(const std::uint64_t ready{ Tracer::now() });
+            if (xi_partial) {
+                // collected first, since submitted nodes decrement the pending counts of their successors
+                static thread_local std::vector<NodeIndex> sources;
+                sources.clear();
+                for (NodeIndex node : mRunNodes) {
+                    if (mPending[node].load(std::memory_order_relaxed) == 0) {
+                        sources.push_back(node);
+                    }
+                }
+                for (NodeIndex node : sources) {
+                    BABYTASK_TRACE(mTraceReady[node] = ready);
+                    submitNode(node);
+                }
+            }
+            else {
+                for (NodeIndex i{ mLevelOffsets[0] }; i < mLevelOffsets[1]; ++i) {
+                    BABYTASK_TRACE(mTraceReady[mLevels[i]] = ready);
+                    submitNode(mLevels[i]);
+                }
+            }
+
+            // every node might have finished already (then a parent graph node completes once this returns)
+            if (mRemaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                finish();
+                return false;
+            }
+
+            return true;
+        }
+
+        /**
+        * \brief collect the nodes an incremental execution runs (in 'mRunNodes', stamped with a new epoch): dirty nodes and
+        *        their descendants, and clean parents of those which can not deliver a kept result (and so must run again).
+        *        clean parents with a kept result deliver it to their descendant arguments.
+        **/
+        void collectDirty() {
+            if (++mRunEpoch == 0) {
+                std::fill(mRunStamp.begin(), mRunStamp.end(), 0);
+                std::fill(mDeliverStamp.begin(), mDeliverStamp.end(), 0);
+                mRunEpoch = 1;
+            }
+
+            // invalidation propagates along descendants
+            mRunNodes.clear();
+            for (NodeIndex node : mDirtyNodes) {
+                mNodes[node]->mDirty = false;
+                if (mRunStamp[node] != mRunEpoch) {
+                    mRunStamp[node] = mRunEpoch;
+                    mRunNodes.push_back(node);
+                }
+            }
+            mDirtyNodes.clear();
+
+            for (std::size_t i{}; i < mRunNodes.size(); ++i) {
+                const NodeIndex node{ mRunNodes[i] };
+                for (NodeIndex j{ mSuccessorOffsets[node] }; j < mSuccessorOffsets[node + 1]; ++j) {
+                    const NodeIndex successor{ mSuccessors[j] };
+                    if (mRunStamp[successor] != mRunEpoch) {
+                        mRunStamp[successor] = mRunEpoch;
+                        mRunNodes.push_back(successor);
+                    }
+                }
+            }
+
+            // clean parents deliver their kept results (a parent without one runs again, and so do its own clean parents)
+            for (std::size_t i{}; i < mRunNodes.size(); ++i) {
+                const NodeIndex node{ mRunNodes[i] };
+                for (NodeIndex j{ mPredecessorOffsets[node] }; j < mPredecessorOffsets[node + 1]; ++j) {
+                    const NodeIndex parent{ mPredecessors[j] };
+                    if ((mRunStamp[parent] == mRunEpoch) || (mDeliverStamp[parent] == mRunEpoch)) {
+                        continue;
+                    }
+
+                    mDeliverStamp[parent] = mRunEpoch;
+                    if (!mNodes[parent]->redeliver()) {
+                        mRunStamp[parent] = mRunEpoch;
+                        mRunNodes.push_back(parent);
+                    }
+                }
+            }
+        }
+
+        /**
+        * \brief intern a node name in arena (in tracer when tracing, so traced names outlive the graph)
+        *
+        * @param {char*,       in}  name
+        * @param {string_view, out} interned name
+        **/
+        std::string_view internName(const char* xi_name) {
+            const std::string_view name{ xi_name ? xi_name : "" };
+            if (name.empty()) {
+                return {};
+            }
+
+            BABYTASK_TRACE(return Tracer::instance().intern(name));
+
+            if (auto it = mNames.find(name); it != mNames.end()) {
+                return *it;
+            }
+
+            char* storage{ static_cast<char*>(mArena.allocate(name.size(), 1)) };
+            name.copy(storage, name.size());
+            return *mNames.emplace(storage, name.size()).first;
+        }
+
+        /**
+        * \brief construct a node in arena and register it
+        *
+        * @param {NodeType,    in}  node type
+        * @param {char*,       in}  node name
+        * @param {NodeArgs..., in}  node constructor arguments (between graph and name)
+        * @param {NodeType,    out} node
+        **/
+        template<typename NodeType, typename... NodeArgs>
+        NodeType* addNode(const char* xi_name, NodeArgs&&... xi_args) {
+            const std::string_view name{ internName(xi_name) };
+            void* storage{ mArena.allocate(sizeof(NodeType), alignof(NodeType)) };
+            NodeType* node{ ::new (storage) NodeType(this, std::forward<NodeArgs>(xi_args)..., name, &mArena) };
+
+            node->mIndex = static_cast<NodeIndex>(mNodes.size());
+            node->mKeepResult = mIncremental;
+            if (mIncremental) {
+                // a new node is dirty (until the first incremental execution, every node is, and none is listed)
+                mDirtyNodes.push_back(node->mIndex);
+            }
+            mNodes.push_back(node);
+            if (mCycleChecking) {
+                mOrder.push_back(static_cast<NodeIndex>(mOrdered.size()));
+                mOrdered.push_back(node->mIndex);
+                mVisitStamp.push_back(0);
+            }
+            mCompiled = false;
+            return node;
+        }
+
         public:
 
-            // constructor (notice that default is one thread in pool)
-            TaskGraph(size_t xi_count = 1) noexcept : mPool(xi_count) {}
+            /**
+            * \brief handle of an asynchronous graph execution
+            **/
+            class ExecutionHandle {
+                TaskGraph* mGraph;
+
+                public:
+
+                    explicit ExecutionHandle(TaskGraph* xi_graph) noexcept : mGraph(xi_graph) {}
+
+                    // block until execution is finished and return its status (rethrows the exception a task has thrown)
+                    ExecutionStatus wait() const {
+                        mGraph->wait();
+                        mGraph->rethrow();
+                        return mGraph->status();
+                    }
+
+                    // test if execution is finished
+                    bool ready() const { return !mGraph->isRunning(); }
+            };
+
+            // constructor with a private executor (notice that default is one thread in pool, nodes are scheduled by work stealing)
+            TaskGraph(size_t xi_count = 1) : TaskGraph(std::make_shared<Executor>(xi_count)) {}
+
+            // constructor with a (shared) executor
+            explicit TaskGraph(std::shared_ptr<Executor> xi_executor) : mExecutor(std::move(xi_executor)), mNames(&mArena) {
+                if (!mExecutor) {
+                    throw std::invalid_argument("task graph requires an executor.");
+                }
+            }
+
+            // destructor (nodes are destroyed in bulk, their memory is released with the arena)
+            ~TaskGraph() noexcept {
+                wait();
+                for (BaseTaskNode* node : mNodes) {
+                    node->~BaseTaskNode();
+                }
+            }
+
+            // copy semantics
+            TaskGraph(const TaskGraph&) = delete;
+            TaskGraph& operator=(const TaskGraph&) = delete;
+
+            // move semantics
+            TaskGraph(TaskGraph&&) noexcept = delete;
+            TaskGraph& operator=(TaskGraph&&) noexcept = delete;
 
             /**
-            * \brief make task nodes
+            * \brief make a task node. the callable is held by its own type inside the node (which is allocated in the graph arena),
+            *        node arguments are deduced from its call operator and its result type from 'std::invoke_result_t'.
+            *
+            * @param {F,        in}  task (lambda, function object or function pointer)
+            * @param {char*,    in}  node name
+            * @param {TaskNode, out} node
             **/
-            template<typename ReturnType, typename... Args>
-            TaskNode<std::function<ReturnType(Args...)>, Args...>* makeTaskNode(std::function<ReturnType(Args...)> xi_task, const char* xi_name = "") {
-                mNodes.emplace_back(std::make_unique<TaskNode<std::function<ReturnType(Args...)>, Args...>>(this, xi_task, xi_name));
-                return static_cast<TaskNode<std::function<ReturnType(Args...)>, Args...>*>(mNodes.back().get());
+            template<typename F>
+            typename CallableTraits<std::decay_t<F>>::template NodeType<std::decay_t<F>>* makeTaskNode(F&& xi_task, const char* xi_name = "") {
+                return addNode<typename CallableTraits<std::decay_t<F>>::template NodeType<std::decay_t<F>>>(xi_name, std::forward<F>(xi_task));
             }
 
-            template<typename... Args>
-            TaskNode<std::function<void(Args...)>, Args...>* makeTaskNode(std::function<void(Args...)> xi_task, const char* xi_name = "") {
-                mNodes.emplace_back(std::make_unique<TaskNode<std::function<void(Args...)>, Args...>>(this, xi_task, xi_name));
-                return static_cast<TaskNode<std::function<void(Args...)>, Args...>*>(mNodes.back().get());
+            /**
+            * \brief connect a parent node result to a child node argument (a typed data flow edge).
+            *        the child argument must be of the parent result type (the result is moved into it when it is
+            *        the only consumer, or copied otherwise) or a 'SharedView' of it (all views share one immutable result).
+            *        a non copyable result can have either a single 'by value' consumer or any amount of views.
+            *
+            * @param {size_t,     in} child argument index
+            * @param {ParentTask, in} parent node
+            * @param {ChildTask,  in} child node
+            **/
+            template<std::size_t ArgIndex, typename ParentTask, typename ChildTask>
+            void connect(ParentTask& xi_parent, ChildTask& xi_child) {
+                using Result = typename ParentTask::ResultStorage;
+                using Argument = std::tuple_element_t<ArgIndex, typename ChildTask::ArgumentStorage>;
+                static_assert(!std::is_void_v<typename ParentTask::ReturnType>, "parent task does not return a result.");
+                static_assert(std::is_same_v<Argument, Result> || std::is_same_v<Argument, SharedView<Result>>,
+                              "child argument must be of parent result type (or a shared view of it).");
+
+                if ((xi_parent.mGraph != this) || (xi_child.mGraph != this)) {
+                    throw std::invalid_argument("connected nodes must belong to this graph.");
+                }
+
+                constexpr std::uint64_t bit{ std::uint64_t{ 1 } << ArgIndex };
+                if (xi_child.mConnected & bit) {
+                    throw std::logic_error("node '" + std::string(xi_child.getName()) + "' argument " + std::to_string(ArgIndex) + " is already connected.");
+                }
+                onEdge(xi_parent, xi_child);
+
+                if constexpr (std::is_same_v<Argument, Result>) {
+                    if constexpr (!std::is_copy_constructible_v<Result>) {
+                        if (!xi_parent.mValueTargets.empty() || !xi_parent.mViewTargets.empty()) {
+                            throw std::logic_error("a non copyable result can not be passed by value to more than one consumer.");
+                        }
+                    }
+                    xi_parent.mValueTargets.push_back(&std::get<ArgIndex>(xi_child.mArguments));
+                }
+                else {
+                    if constexpr (!std::is_copy_constructible_v<Result>) {
+                        if (!xi_parent.mValueTargets.empty()) {
+                            throw std::logic_error("a non copyable result can not be passed by value to more than one consumer.");
+                        }
+                    }
+                    xi_parent.mViewTargets.push_back(&std::get<ArgIndex>(xi_child.mArguments));
+                }
+
+                xi_child.mConnected |= bit;
+                xi_parent.mDescendants.emplace_back(&xi_child);
+                onTopologyChanged();
+            }
+
+            /**
+            * \brief make a node which calls 'body(i)' for every index in [begin, end), split across pool workers
+            *
+            * @param {Index,           in}  range begin
+            * @param {Index,           in}  range end
+            * @param {size_t,          in}  minimal chunk size (0 - chosen by amount of workers)
+            * @param {Body,            in}  body (callable as 'void(Index)')
+            * @param {char*,           in}  node name
+            * @param {ParallelForNode, out} node
+            **/
+            template<typename Index, typename Body>
+            ParallelForNode<Index, std::decay_t<Body>>* makeParallelForNode(Index xi_begin, Index xi_end, std::size_t xi_grain, Body&& xi_body, const char* xi_name = "") {
+                return addNode<ParallelForNode<Index, std::decay_t<Body>>>(xi_name, xi_begin, xi_end, xi_grain, std::forward<Body>(xi_body));
             }
 
-            TaskNode<std::function<void()>>* makeTaskNode(std::function<void()> xi_task, const char* xi_name = "") {
-                mNodes.emplace_back(std::make_unique<TaskNode<std::function<void()>>>(this, xi_task, xi_name));
-                return static_cast<TaskNode<std::function<void()>>*>(mNodes.back().get());
+            /**
+            * \brief make a node which reduces [begin, end) on pool workers: chunks are folded into partial results
+            *        ('body(begin, end, partial)', starting from 'identity') which are then combined ('combine(left, right)')
+            *
+            * @param {Index,              in}  range begin
+            * @param {Index,              in}  range end
+            * @param {size_t,             in}  minimal chunk size (0 - chosen by amount of workers)
+            * @param {T,                  in}  identity (initial partial result)
+            * @param {Body,               in}  body (callable as 'T(Index, Index, T)')
+            * @param {Combine,            in}  combine (callable as 'T(T, T)', associative and commutative)
+            * @param {char*,              in}  node name
+            * @param {ParallelReduceNode, out} node (its result is returned by 'getValue')
+            **/
+            template<typename Index, typename T, typename Body, typename Combine>
+            ParallelReduceNode<Index, T, std::decay_t<Body>, std::decay_t<Combine>>* makeParallelReduceNode(Index xi_begin, Index xi_end, std::size_t xi_grain, T xi_identity,
+                                                                                                          Body&& xi_body, Combine&& xi_combine, const char* xi_name = "") {
+                return addNode<ParallelReduceNode<Index, T, std::decay_t<Body>, std::decay_t<Combine>>>(xi_name, xi_begin, xi_end, xi_grain, std::move(xi_identity),
+                                                                                                         std::forward<Body>(xi_body), std::forward<Combine>(xi_combine));
             }
 
             /**
-            * \brief test for cycles in graph
+            * \brief make a node whose callable ('void(Subflow&)') creates tasks and edges while it runs.
+            *        those form a subgraph which runs on this graph executor once the callable returns,
+            *        and node descendants start only once the whole subgraph has completed.
+            *
+            * @param {F,           in}  task (callable as 'void(Subflow&)')
+            * @param {char*,       in}  node name
+            * @param {SubflowNode, out} node
+            **/
+            template<typename F>
+            SubflowNode<std::decay_t<F>>* makeSubflowNode(F&& xi_task, const char* xi_name = "") {
+                return addNode<SubflowNode<std::decay_t<F>>>(xi_name, std::forward<F>(xi_task));
+            }
+
+            /**
+            * \brief make a condition node - its callable returns the index of the successor (in declaration order) which runs next.
+            *        the other successors, and every node reachable only through them, are skipped without being scheduled
+            *        (a node runs if any of its parents ran and did not branch away from it).
+            *        notice that an argument produced by a skipped node is not delivered.
+            *
+            * @param {F,             in}  task (callable as 'integral()')
+            * @param {char*,         in}  node name
+            * @param {ConditionNode, out} node
+            **/
+            template<typename F>
+            ConditionNode<std::decay_t<F>>* makeConditionNode(F&& xi_task, const char* xi_name = "") {
+                mHasConditions = true;
+                return addNode<ConditionNode<std::decay_t<F>>>(xi_name, std::forward<F>(xi_task));
+            }
+
+            /**
+            * \brief make a node which executes a prebuilt graph, node descendants start once that graph has completed.
+            *        the nested graph must outlive this graph and must not be executed elsewhere while the node runs.
+            *
+            * @param {TaskGraph, in}  graph
+            * @param {char*,     in}  node name
+            * @param {GraphNode, out} node
+            **/
+            GraphNode* makeGraphNode(TaskGraph& xi_graph, const char* xi_name = "") {
+                if (&xi_graph == this) {
+                    throw std::invalid_argument("a task graph can not be nested in itself.");
+                }
+                return addNode<GraphNode>(xi_name, &xi_graph);
+            }
+
+            // return amount of nodes in graph
+            std::size_t size() const { return mNodes.size(); }
+
+            /**
+            * \brief remove all nodes (waits for current execution to finish first). node memory is reused by nodes made later.
+            **/
+            void clear() {
+                wait();
+                for (BaseTaskNode* node : mNodes) {
+                    node->~BaseTaskNode();
+                }
+                mNodes.clear();
+                mRanks.clear();
+                mHasConditions = false;
+                mIncremental = false;
+                mDirtyNodes.clear();
+                mRunNodes.clear();
+                mOrder.clear();
+                mOrdered.clear();
+                mVisitStamp.clear();
+                std::pmr::unordered_set<std::string_view>(&mArena).swap(mNames);
+                mArena.release();
+                mCompiled = false;
+            }
+
+            /**
+            * \brief test for cycles in graph (iterative, linear in amount of nodes and edges)
             *
             * @param {bool, out} true if a cycle was found
             **/
             bool hasCycle() const {
-                std::unordered_map<BaseTaskNode*, bool> col;
-
-                // recursive implementation of depth-first-search
-                std::function<bool(BaseTaskNode*)> DFS = [&](BaseTaskNode* currentNode) -> bool {
-                    col[currentNode] = true;
-                    for (auto& nextNode : currentNode->mDescendants) {
-                        if (!col.count(nextNode)) {
-                            if (DFS(nextNode)) {
-                                return true;
+                return !findCycle().empty();
+            }
+
+            /**
+            * \brief find a cycle in graph - an iterative depth first search (linear in amount of nodes and edges)
+            *        which stops at the first edge leading back to a node on its path
+            *
+            * @param {vector<BaseTaskNode*>, out} nodes along the cycle (the last one is a parent of the first), empty if graph has no cycle
+            **/
+            std::vector<BaseTaskNode*> findCycle() const {
+                enum : std::uint8_t { Unvisited, OnPath, Done };
+                std::vector<std::uint8_t> state(mNodes.size(), Unvisited);
+                std::vector<std::pair<NodeIndex, std::size_t>> path;    // node and its next descendant to visit
+
+                for (std::size_t root{}; root < mNodes.size(); ++root) {
+                    if (state[root] != Unvisited) {
+                        continue;
+                    }
+
+                    state[root] = OnPath;
+                    path.emplace_back(static_cast<NodeIndex>(root), 0);
+                    while (!path.empty()) {
+                        const BaseTaskNode* node{ mNodes[path.back().first] };
+                        if (path.back().second == node->mDescendants.size()) {
+                            state[path.back().first] = Done;
+                            path.pop_back();
+                            continue;
+                        }
+
+                        const NodeIndex next{ node->mDescendants[path.back().second++]->mIndex };
+                        if (state[next] == Unvisited) {
+                            state[next] = OnPath;
+                            path.emplace_back(next, 0);
+                        }
+                        else if (state[next] == OnPath) {
+                            std::vector<BaseTaskNode*> cycle;
+                            auto it = std::find_if(path.begin(), path.end(), [next](const auto& step) { return step.first == next; });
+                            for (; it != path.end(); ++it) {
+                                cycle.push_back(mNodes[it->first]);
                             }
+                            return cycle;
                         }
-                        else if (col[nextNode] == true) {
-                            return true;
+                    }
+                }
+
+                return {};
+            }
+
+            /**
+            * \brief return nodes in topological order - by topological level, a node comes after all of its parents
+            *        (compiles graph first if its structure has changed, so it throws if graph has a cycle)
+            *
+            * @param {vector<BaseTaskNode*>, out} nodes in topological order
+            **/
+            std::vector<BaseTaskNode*> topologicalOrder() {
+                if (!mCompiled) {
+                    compile();
+                }
+
+                std::vector<BaseTaskNode*> order;
+                order.reserve(mLevels.size());
+                for (NodeIndex node : mLevels) {
+                    order.push_back(mNodes[node]);
+                }
+                return order;
+            }
+
+            /**
+            * \brief return nodes by topological level - level 0 are the nodes without parents, and the parents of a node
+            *        at level l are at levels below l (compiles graph first if its structure has changed, so it throws if graph has a cycle)
+            *
+            * @param {vector<vector<BaseTaskNode*>>, out} nodes of every level
+            **/
+            std::vector<std::vector<BaseTaskNode*>> levels() {
+                if (!mCompiled) {
+                    compile();
+                }
+
+                std::vector<std::vector<BaseTaskNode*>> result(mLevelOffsets.size() - 1);
+                for (std::size_t l{}; l < result.size(); ++l) {
+                    for (NodeIndex i{ mLevelOffsets[l] }; i < mLevelOffsets[l + 1]; ++i) {
+                        result[l].push_back(mNodes[mLevels[i]]);
+                    }
+                }
+                return result;
+            }
+
+            /**
+            * \brief enable/disable cycle checking: once enabled, declaring an edge (by 'setParent' or 'connect') which
+            *        closes a cycle throws and leaves the graph unchanged. a topological order of the nodes is kept as edges
+            *        are declared - an edge which agrees with it costs nothing, otherwise only the nodes between its ends
+            *        (in that order) are searched and reordered.
+            *        throws if graph already has a cycle.
+            *
+            * @param {bool, in} true to check edges as they are declared
+            **/
+            void setCycleChecking(bool xi_enable) {
+                mCycleChecking = false;
+                mOrder.clear();
+                mOrdered.clear();
+                mVisitStamp.clear();
+                if (!xi_enable) {
+                    return;
+                }
+
+                // initial order (Kahn)
+                const std::size_t count{ mNodes.size() };
+                std::vector<NodeIndex> inDegree(count, 0);
+                for (const BaseTaskNode* node : mNodes) {
+                    for (const BaseTaskNode* descendant : node->mDescendants) {
+                        ++inDegree[descendant->mIndex];
+                    }
+                }
+
+                for (std::size_t i{}; i < count; ++i) {
+                    if (inDegree[i] == 0) {
+                        mOrdered.push_back(static_cast<NodeIndex>(i));
+                    }
+                }
+                for (std::size_t i{}; i < mOrdered.size(); ++i) {
+                    for (const BaseTaskNode* descendant : mNodes[mOrdered[i]]->mDescendants) {
+                        if (--inDegree[descendant->mIndex] == 0) {
+                            mOrdered.push_back(descendant->mIndex);
                         }
                     }
+                }
 
-                    col[currentNode] = false;
-                    return false;
-                };
+                if (mOrdered.size() != count) {
+                    mOrdered.clear();
+                    throw std::logic_error("task graph has a cycle: " + describeCycle(findCycle()) + ".");
+                }
+
+                mOrder.resize(count);
+                for (std::size_t p{}; p < count; ++p) {
+                    mOrder[mOrdered[p]] = static_cast<NodeIndex>(p);
+                }
+                mVisitStamp.assign(count, 0);
+                mCycleChecking = true;
+            }
+
+            // return true if edges are checked for cycles as they are declared
+            bool getCycleChecking() const { return mCycleChecking; }
 
-                for (auto& node : mNodes) {
-                    col.clear();
-                    if (DFS(node.get())) {
-                        return true;
+            /**
+            * \brief freeze graph structure into flat arrays: successors (CSR), initial pending counts,
+            *        source nodes and topological levels. called by 'execute' whenever the structure has changed.
+            *        throws if graph has a cycle or a node argument has no producer.
+            **/
+            void compile() {
+                const std::size_t count{ mNodes.size() };
+
+                mInitialPending.assign(count, 0);
+                mSuccessorOffsets.assign(count + 1, 0);
+                mSuccessors.clear();
+
+                // successors (CSR)
+                for (std::size_t i{}; i < count; ++i) {
+                    for (BaseTaskNode* descendant : mNodes[i]->mDescendants) {
+                        mSuccessors.push_back(static_cast<NodeIndex>(descendant->mIndex));
                     }
+                    mSuccessorOffsets[i + 1] = static_cast<NodeIndex>(mSuccessors.size());
                 }
 
-                return false;
+                // pending counts (a node argument must be produced by a parent)
+                std::vector<NodeIndex> inDegree(count, 0);
+                for (NodeIndex successor : mSuccessors) {
+                    ++inDegree[successor];
+                }
+
+                // predecessors (CSR)
+                mPredecessorOffsets.assign(count + 1, 0);
+                for (std::size_t i{}; i < count; ++i) {
+                    mPredecessorOffsets[i + 1] = mPredecessorOffsets[i] + inDegree[i];
+                }
+                mPredecessors.resize(mSuccessors.size());
+                {
+                    std::vector<NodeIndex> cursor(mPredecessorOffsets.begin(), mPredecessorOffsets.end() - 1);
+                    for (std::size_t i{}; i < count; ++i) {
+                        for (NodeIndex j{ mSuccessorOffsets[i] }; j < mSuccessorOffsets[i + 1]; ++j) {
+                            mPredecessors[cursor[mSuccessors[j]]++] = static_cast<NodeIndex>(i);
+                        }
+                    }
+                }
+                mRunStamp.assign(count, 0);
+                mDeliverStamp.assign(count, 0);
+
+                for (std::size_t i{}; i < count; ++i) {
+                    if (inDegree[i] < mNodes[i]->mParentCount) {
+                        throw std::logic_error("node '" + std::string(mNodes[i]->getName()) + "' has an argument without a producer.");
+                    }
+                    mInitialPending[i] = inDegree[i];
+                }
+
+                // topological levels (Kahn)
+                mLevels.clear();
+                mLevelOffsets.assign(1, 0);
+                for (std::size_t i{}; i < count; ++i) {
+                    if (inDegree[i] == 0) {
+                        mLevels.push_back(static_cast<NodeIndex>(i));
+                    }
+                }
+
+                for (std::size_t begin{}; begin < mLevels.size();) {
+                    const std::size_t end{ mLevels.size() };
+                    mLevelOffsets.push_back(static_cast<NodeIndex>(end));
+
+                    for (std::size_t i{ begin }; i < end; ++i) {
+                        const NodeIndex node{ mLevels[i] };
+                        for (NodeIndex j{ mSuccessorOffsets[node] }; j < mSuccessorOffsets[node + 1]; ++j) {
+                            if (--inDegree[mSuccessors[j]] == 0) {
+                                mLevels.push_back(mSuccessors[j]);
+                            }
+                        }
+                    }
+
+                    begin = end;
+                }
+
+                if (mLevels.size() != count) {
+                    throw std::logic_error("task graph has a cycle: " + describeCycle(findCycle()) + ".");
+                }
+
+                BABYTASK_TRACE(mTraceReady.reset(new std::uint64_t[count]()));
+                BABYTASK_TRACE(mTraceStart.reset(new std::uint64_t[count]()));
+                BABYTASK_TRACE(mTraceEnd.reset(new std::uint64_t[count]()));
+                mPending.reset(new std::atomic<NodeIndex>[count]);
+                mLive.reset(mHasConditions ? new std::atomic<NodeIndex>[count] : nullptr);
+                for (std::size_t i{}; i < count; ++i) {
+                    mPending[i].store(mInitialPending[i], std::memory_order_relaxed);
+                }
+
+                mCompiled = true;
+            }
+
+            // return true if graph structure is compiled
+            bool isCompiled() const { return mCompiled; }
+
+            /**
+            * \brief return number of parents of a given node which have not finished yet
+            *
+            * @param {BaseTaskNode, in}  node
+            * @param {size_t,       out} pending count
+            **/
+            std::size_t getPendingCount(const BaseTaskNode& xi_node) const {
+                return mCompiled ? mPending[xi_node.mIndex].load(std::memory_order_acquire) : xi_node.mParentCount;
             }
 
             /**
             * \brief reset the graph
             **/
             void reset() {
-                for (auto& node : mNodes) {
+                for (BaseTaskNode* node : mNodes) {
                     node->reset();
                 }
+            }
 
-                mCompletedTasks = 0;
+            /**
+            * \brief start executing task graph and return without waiting for it to finish
+            *        (compiles graph first if its structure has changed). throws if graph is already being executed.
+            *
+            * @param {ExecutionHandle, out} handle to wait on
+            **/
+            ExecutionHandle executeAsync() {
+                launch(nullptr, NoNode);
+                return ExecutionHandle(this);
             }
 
             /**
-            * \brief execute task graph
+            * \brief start executing task graph, which stops once a token is cancelled or a deadline has passed,
+            *        and return without waiting for it to finish. a stopped execution skips every node which has not started yet
+            *        (their descendants get no new arguments), nodes which are running can poll 'stopRequested'.
+            *        throws if graph is already being executed.
+            *
+            * @param {CancellationToken, in}  cancellation token
+            * @param {Deadline,          in}  deadline (NoDeadline for none)
+            * @param {ExecutionHandle,   out} handle to wait on
             **/
-            void execute() {
-                std::vector<BaseTaskNode*> initialNodes;
+            ExecutionHandle executeAsync(const CancellationToken& xi_token, Deadline xi_deadline = NoDeadline) {
+                launch(nullptr, NoNode, false, xi_token.mCancelled, xi_deadline);
+                return ExecutionHandle(this);
+            }
 
-                for (auto& nodePtr : mNodes) {
-                    if (!nodePtr->getPendingCount()) {
-                        initialNodes.push_back(nodePtr.get());
-                    }
-                }
+            /**
+            * \brief execute task graph and wait for it to finish
+            *
+            * @param {ExecutionStatus, out} execution status (always 'Completed')
+            **/
+            ExecutionStatus execute() {
+                return executeAsync().wait();
+            }
 
-                for (auto* initialNode : initialNodes) {
-                    mPool.push(std::bind(&BaseTaskNode::execute, initialNode));
-                }
+            /**
+            * \brief execute task graph and wait for it to finish or stop (see 'executeAsync')
+            *
+            * @param {CancellationToken, in}  cancellation token
+            * @param {Deadline,          in}  deadline (NoDeadline for none)
+            * @param {ExecutionStatus,   out} execution status
+            **/
+            ExecutionStatus execute(const CancellationToken& xi_token, Deadline xi_deadline = NoDeadline) {
+                return executeAsync(xi_token, xi_deadline).wait();
+            }
 
-                {
-                    std::unique_lock<std::mutex> lock(mMutex);
-                    mConditionVariable.wait(lock, [this]() { return mCompletedTasks == mNodes.size(); });
+            /**
+            * \brief execute task graph within a time budget and wait for it to finish or stop (see 'executeAsync')
+            *
+            * @param {duration,        in}  time budget
+            * @param {ExecutionStatus, out} execution status
+            **/
+            template<typename Rep, typename Period>
+            ExecutionStatus executeFor(std::chrono::duration<Rep, Period> xi_budget) {
+                launch(nullptr, NoNode, false, nullptr, std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(xi_budget));
+                return ExecutionHandle(this).wait();
+            }
+
+            // return status of current (or last) execution
+            ExecutionStatus status() const { return mStatus.load(std::memory_order_acquire); }
+
+            /**
+            * \brief test if the execution whose node runs on current thread should stop (its token was cancelled
+            *        or its deadline has passed). to be polled by long running tasks, false if not called from a task of a graph.
+            *
+            * @param {bool, out} true if task should return early
+            **/
+            static bool stopRequested() {
+                TaskGraph* graph{ const_cast<TaskGraph*>(currentContinuation().mGraph) };
+                return graph && graph->shouldStop();
+            }
+
+            /**
+            * \brief mark a node dirty - it (and every node downstream of it) runs on next incremental execution
+            *
+            * @param {BaseTaskNode, in} node
+            **/
+            void markDirty(BaseTaskNode& xi_node) {
+                if (!xi_node.mDirty) {
+                    xi_node.mDirty = true;
+                    mDirtyNodes.push_back(xi_node.mIndex);
                 }
             }
 
+            // test if a node is marked dirty
+            bool isDirty(const BaseTaskNode& xi_node) const { return xi_node.mDirty; }
+
+            /**
+            * \brief execute only the nodes affected since last incremental execution - dirty nodes and their descendants -
+            *        and wait for them to finish. clean nodes are not executed, their kept results are delivered again instead.
+            *        the first incremental execution (or one after the graph structure has changed) executes every node,
+            *        and from then on nodes keep their results (so a result consumed by value is copied, not moved).
+            *        a graph with condition nodes is always executed in full.
+            *
+            * @param {size_t, out} amount of executed nodes
+            **/
+            std::size_t executeIncremental() {
+                return executeIncremental(nullptr, NoDeadline);
+            }
+
             /**
-            * \brief execute a single node
+            * \brief execute only the nodes affected since last incremental execution (see above), stopping once a token is cancelled
+            *        or a deadline has passed (see 'executeAsync'). nodes of a stopped execution stay dirty (see 'status').
             *
-            * @param {NodeType, in} node to be executed
+            * @param {CancellationToken, in}  cancellation token
+            * @param {Deadline,          in}  deadline (NoDeadline for none)
+            * @param {size_t,            out} amount of nodes the execution was to run
             **/
-            template<typename NodeType>
-            void executeSingleNode(NodeType* xi_node) {
-                mPool.push(std::bind(&NodeType::execute, xi_node));
+            std::size_t executeIncremental(const CancellationToken& xi_token, Deadline xi_deadline = NoDeadline) {
+                return executeIncremental(xi_token.mCancelled, xi_deadline);
+            }
+
+            // block until current execution (if any) is finished
+            void wait() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mConditionVariable.wait(lock, [this]() { return !mRunning; });
+            }
+
+            // test if graph is being executed
+            bool isRunning() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                return mRunning;
             }
 
             /**
-            * \brief callback to be executed when single node is completed
+            * \brief set maximal amount of successive ready descendants a worker executes inline
+            *        (without going through the pool queue), zero disables inline execution
+            *
+            * @param {size_t, in} inline depth cap
+            **/
+            void setMaxInlineDepth(std::size_t xi_depth) { mMaxInlineDepth = xi_depth; }
+
+            // return inline depth cap
+            std::size_t getMaxInlineDepth() const { return mMaxInlineDepth; }
+
+            /**
+            * \brief enable/disable critical path scheduling (between executions): ready nodes are dispatched by their
+            *        upward rank (node cost plus the longest path of costs after it), so long chains are not delayed
+            *        by short side branches. node costs are supplied by 'setCost' or measured on earlier executions.
+            *
+            * @param {bool, in} true to schedule by priority
             **/
-            void onSingleNodeCompleted() {
+            void setPriorityScheduling(bool xi_enable) {
                 std::unique_lock<std::mutex> lock(mMutex);
-                ++mCompletedTasks;
-                mConditionVariable.notify_all();
+                if (mRunning) {
+                    throw std::logic_error("task graph is being executed.");
+                }
+                mPriorityScheduling = xi_enable;
+            }
+
+            // return true if ready nodes are dispatched by priority
+            bool getPriorityScheduling() const { return mPriorityScheduling; }
+
+            /**
+            * \brief set node execution cost (overrides measured cost, a negative cost reverts to measured cost)
+            *
+            * @param {BaseTaskNode, in} node
+            * @param {float,        in} cost (in microseconds)
+            **/
+            void setCost(BaseTaskNode& xi_node, float xi_cost) { xi_node.mCost = xi_cost; }
+
+            /**
+            * \brief set the NUMA node a node prefers to run on (i.e. - the node where the data it consumes was produced).
+            *        used only if graph executor workers are pinned (see 'Placement') and priority scheduling is off.
+            *
+            * @param {BaseTaskNode, in} node
+            * @param {size_t,       in} NUMA node (AnyNode for no preference)
+            **/
+            void setLocality(BaseTaskNode& xi_node, std::size_t xi_numaNode) { xi_node.mLocality = xi_numaNode; }
+
+            // return the NUMA node a node prefers to run on (AnyNode if none)
+            std::size_t getLocality(const BaseTaskNode& xi_node) const { return xi_node.mLocality; }
+
+            /**
+            * \brief return node upward rank (as computed for last execution with priority scheduling)
+            *
+            * @param {BaseTaskNode, in}  node
+            * @param {float,        out} rank (in microseconds)
+            **/
+            float getRank(const BaseTaskNode& xi_node) const {
+                return (xi_node.mIndex < mRanks.size()) ? mRanks[xi_node.mIndex] : 0.0f;
+            }
+
+            // return graph executor
+            const std::shared_ptr<Executor>& getExecutor() const { return mExecutor; }
+
+        // internals
+        private:
+
+            // called when a node declares a new parent
+            void onTopologyChanged() { mCompiled = false; }
+
+            // describe a node by its name (unnamed nodes by their index)
+            static std::string describeNode(const BaseTaskNode& xi_node) {
+                return xi_node.getName().empty() ? ("#" + std::to_string(xi_node.mIndex)) : ("'" + std::string(xi_node.getName()) + "'");
+            }
+
+            // describe a cycle as 'a' -> 'b' -> 'a'
+            static std::string describeCycle(const std::vector<BaseTaskNode*>& xi_cycle) {
+                std::string description;
+                for (std::size_t i{}; i <= xi_cycle.size(); ++i) {
+                    description += ((i > 0) ? " -> " : "") + describeNode(*xi_cycle[i % xi_cycle.size()]);
+                }
+                return description;
+            }
+
+            /**
+            * \brief called before an edge is declared - when checking cycles, throws if it closes one, and otherwise
+            *        keeps the topological order valid: if the child is ordered before the parent, the nodes it reaches
+            *        which are ordered up to the parent (the parent is not among them) are moved right after the parent.
+            *
+            * @param {BaseTaskNode, in} parent
+            * @param {BaseTaskNode, in} child
+            **/
+            void onEdge(const BaseTaskNode& xi_parent, const BaseTaskNode& xi_child) {
+                if (!mCycleChecking) {
+                    return;
+                }
+
+                const NodeIndex parent{ xi_parent.mIndex };
+                const NodeIndex child{ xi_child.mIndex };
+                if (parent == child) {
+                    throw std::logic_error("edge " + describeNode(xi_parent) + " -> " + describeNode(xi_child) + " closes a cycle.");
+                }
+
+                const NodeIndex lower{ mOrder[child] };
+                const NodeIndex upper{ mOrder[parent] };
+                if (lower > upper) {
+                    return;
+                }
+
+                if (++mVisitEpoch == 0) {
+                    std::fill(mVisitStamp.begin(), mVisitStamp.end(), 0);
+                    mVisitEpoch = 1;
+                }
+
+                // nodes reachable from child, ordered up to parent
+                mSearch.assign(1, child);
+                mVisitStamp[child] = mVisitEpoch;
+                while (!mSearch.empty()) {
+                    const NodeIndex node{ mSearch.back() };
+                    mSearch.pop_back();
+                    for (const BaseTaskNode* descendant : mNodes[node]->mDescendants) {
+                        const NodeIndex next{ descendant->mIndex };
+                        if (next == parent) {
+                            throw std::logic_error("edge " + describeNode(xi_parent) + " -> " + describeNode(xi_child) + " closes a cycle.");
+                        }
+                        if ((mOrder[next] <= upper) && (mVisitStamp[next] != mVisitEpoch)) {
+                            mVisitStamp[next] = mVisitEpoch;
+                            mSearch.push_back(next);
+                        }
+                    }
+                }
+
+                // reorder positions [lower, upper]: nodes which were not reached keep their relative order and come first
+                NodeIndex position{ lower };
+                for (NodeIndex p{ lower }; p <= upper; ++p) {
+                    const NodeIndex node{ mOrdered[p] };
+                    if (mVisitStamp[node] == mVisitEpoch) {
+                        mSearch.push_back(node);
+                    }
+                    else {
+                        mOrdered[position++] = node;
+                    }
+                }
+                for (NodeIndex node : mSearch) {
+                    mOrdered[position++] = node;
+                }
+                for (NodeIndex p{ lower }; p <= upper; ++p) {
+                    mOrder[mOrdered[p]] = p;
+                }
+            }
+
+            // incremental execution (see 'executeIncremental'), a null cancellation flag and no deadline never stop it
+            std::size_t executeIncremental(std::shared_ptr<std::atomic<bool>> xi_cancelled, Deadline xi_deadline) {
+                if (!mIncremental || !mCompiled || mHasConditions) {
+                    if (!mIncremental) {
+                        mIncremental = true;
+                        for (BaseTaskNode* node : mNodes) {
+                            node->mKeepResult = true;
+                        }
+                    }
+
+                    for (BaseTaskNode* node : mNodes) {
+                        node->mDirty = false;
+                    }
+                    mDirtyNodes.clear();
+                    launch(nullptr, NoNode, false, std::move(xi_cancelled), xi_deadline);
+                    wait();
+                    if (status() != ExecutionStatus::Completed) {
+                        for (BaseTaskNode* node : mNodes) {
+                            markDirty(*node);
+                        }
+                        rethrow();
+                    }
+                    return mNodes.size();
+                }
+
+                collectDirty();
+                launch(nullptr, NoNode, true, std::move(xi_cancelled), xi_deadline);
+                wait();
+                if (status() != ExecutionStatus::Completed) {
+                    for (NodeIndex node : mRunNodes) {
+                        markDirty(*mNodes[node]);
+                    }
+                    rethrow();
+                }
+                return mRunNodes.size();
             }
     };
+
+    //
+    // BaseTaskNode members which require TaskGraph to be a complete type
+    //
+
+    inline std::size_t BaseTaskNode::getPendingCount() const {
+        return mGraph->getPendingCount(*this);
+    }
+
+    inline void BaseTaskNode::setParent(BaseTaskNode& xi_parent) {
+        mGraph->onEdge(xi_parent, *this);
+        ++mParentCount;
+        xi_parent.mDescendants.emplace_back(this);
+        mGraph->onTopologyChanged();
+    }
+
+    //
+    // ParallelTaskNode members which require TaskGraph to be a complete type
+    //
+
+    template<typename Index>
+    bool ParallelTaskNode<Index>::stopRequested() const {
+        return mGraph->shouldStop();
+    }
+
+    template<typename Index>
+    void ParallelTaskNode<Index>::fail() const {
+        mGraph->fail(std::current_exception());
+    }
+
+    template<typename Index>
+    bool ParallelTaskNode<Index>::execute() {
+        const std::size_t count{ (mEnd > mBegin) ? static_cast<std::size_t>(mEnd - mBegin) : 0 };
+        const std::size_t workers{ mGraph->mExecutor->size() };
+
+        // by default, about eight chunks per worker (to balance uneven chunks)
+        mChunkGrain = (mGrain > 0) ? mGrain : std::max<std::size_t>(1, count / (8 * workers));
+        mParticipants = std::max<std::size_t>(1, std::min(workers, (count + mChunkGrain - 1) / mChunkGrain));
+        onStart(mParticipants);
+        mNext.store(mBegin, std::memory_order_relaxed);
+        const std::uint32_t run{ ++mRun };
+        mState.store((std::uint64_t{ run } << 32) | 1, std::memory_order_relaxed);
+
+        // helpers (a range which fits one grain has none). a helper joins only if the node has not finished yet, and the last
+        // participant to finish completes the node. a helper holds the graph execution (not the node) until it is dequeued.
+        if (mParticipants > 1) {
+            mGraph->mRemaining.fetch_add(mParticipants - 1, std::memory_order_relaxed);
+        }
+        for (std::size_t i{ 1 }; i < mParticipants; ++i) {
+            mGraph->mExecutor->submit([this, i, run](std::size_t id) {
+                if (join(run) && participate(i)) {
+                    mGraph->completeNode(mIndex, id);
+                }
+                mGraph->onNodeCompleted(id);
+            });
+        }
+
+        return participate(0);
+    }
+
+    //
+    // SubflowNode, ConditionNode, GraphNode and Subflow members which require TaskGraph to be a complete type
+    //
+
+    template<typename TaskCallback>
+    bool SubflowNode<TaskCallback>::execute() {
+        if (!mSubgraph) {
+            mSubgraph = std::make_unique<TaskGraph>(mGraph->mExecutor);
+        }
+        else {
+            mSubgraph->clear();
+        }
+
+        Subflow subflow(*mSubgraph);
+        mCallback(subflow);
+        return !mSubgraph->launch(mGraph, mIndex);
+    }
+
+    inline bool GraphNode::execute() {
+        return !mNested->launch(mGraph, mIndex);
+    }
+
+    template<typename F>
+    typename CallableTraits<std::decay_t<F>>::template NodeType<std::decay_t<F>>* Subflow::makeTaskNode(F&& xi_task, const char* xi_name) {
+        return mGraph.makeTaskNode(std::forward<F>(xi_task), xi_name);
+    }
+
+    template<typename F>
+    SubflowNode<std::decay_t<F>>* Subflow::makeSubflowNode(F&& xi_task, const char* xi_name) {
+        return mGraph.makeSubflowNode(std::forward<F>(xi_task), xi_name);
+    }
+
+    template<typename F>
+    ConditionNode<std::decay_t<F>>* Subflow::makeConditionNode(F&& xi_task, const char* xi_name) {
+        return mGraph.makeConditionNode(std::forward<F>(xi_task), xi_name);
+    }
+
+    inline GraphNode* Subflow::makeGraphNode(TaskGraph& xi_graph, const char* xi_name) {
+        return mGraph.makeGraphNode(xi_graph, xi_name);
+    }
+
+    template<std::size_t ArgIndex, typename ParentTask, typename ChildTask>
+    void Subflow::connect(ParentTask& xi_parent, ChildTask& xi_child) {
+        mGraph.template connect<ArgIndex>(xi_parent, xi_child);
+    }
+
+    inline std::size_t Subflow::size() const {
+        return mGraph.size();
+    }
 };
\ No newline at end of file
@@ -26,15 +26,45 @@
 #pragma once
 
 #include "BaseTaskNode.h"
+#include "MemoCache.h"
 #include <optional>
 #include <tuple>
 #include <atomic>
 #include <type_traits>
 #include <functional>
 #include <exception>
+#include <memory>
+#include <utility>
+#include <cstdint>
 
 namespace BabyTask {
 
+    class TaskGraph;
+    template<typename TaskCallback, typename... Args> class TaskNode;
+
+    /**
+    * \brief immutable reference counted view of a node result, shared by all the descendants it is connected to
+    **/
+    template<typename T> using SharedView = std::shared_ptr<const T>;
+
+    /**
+    * \brief deduce a callable argument types (lambdas, function objects with a single call operator and function pointers)
+    *
+    * @param {F} callable type
+    **/
+    template<typename F> struct CallableTraits : CallableTraits<decltype(&F::operator())> {};
+
+    template<typename R, typename... A> struct CallableTraits<R(A...)> {
+        template<typename TaskCallback> using NodeType = TaskNode<TaskCallback, A...>;
+    };
+
+    template<typename R, typename... A> struct CallableTraits<R(*)(A...)> : CallableTraits<R(A...)> {};
+    template<typename R, typename... A> struct CallableTraits<R(*)(A...) noexcept> : CallableTraits<R(A...)> {};
+    template<typename C, typename R, typename... A> struct CallableTraits<R(C::*)(A...)> : CallableTraits<R(A...)> {};
+    template<typename C, typename R, typename... A> struct CallableTraits<R(C::*)(A...) const> : CallableTraits<R(A...)> {};
+    template<typename C, typename R, typename... A> struct CallableTraits<R(C::*)(A...) noexcept> : CallableTraits<R(A...)> {};
+    template<typename C, typename R, typename... A> struct CallableTraits<R(C::*)(A...) const noexcept> : CallableTraits<R(A...)> {};
+
     /**
     * \brief a task in the graph
     *
@@ -43,6 +73,8 @@ namespace BabyTask {
     **/
     template<typename TaskCallback, typename... Args>
     class TaskNode final : public BaseTaskNode {
+        static_assert(sizeof...(Args) <= 64, "task node can have at most 64 arguments.");
+
         // friends
         friend class TaskGraph;
 
@@ -52,128 +84,246 @@ namespace BabyTask {
             // aliases
             using ReturnType             = std::invoke_result_t<TaskCallback, Args...>;
             using ResultStorage          = typename std::conditional<!std::is_void_v<ReturnType>, ReturnType, std::size_t>::type; // size_t = placeholder type for void-returning function 
-            using SubscribeCallback      = std::function<void(typename std::conditional<!std::is_void_v<ReturnType>, ReturnType, std::false_type>::type)>;
-            using SubscribeNoArgCallback = std::function<void(void)>;   
+            using ArgumentStorage        = std::tuple<std::decay_t<Args>...>;
 
             // value constructor
-            explicit TaskNode(TaskGraph* xi_graph, TaskCallback xi_task, const char* xi_name) : BaseTaskNode(xi_name), 
-                                                                                                mGraph(xi_graph), 
-                                                                                                mTask(xi_task) {}
+            explicit TaskNode(TaskGraph* xi_graph, TaskCallback xi_task, std::string_view xi_name, std::pmr::memory_resource* xi_resource) : BaseTaskNode(xi_graph, xi_name, xi_resource), 
+                                                                                                                                     mTask(std::move(xi_task)),
+                                                                                                                                     mValueTargets(xi_resource),
+                                                                                                                                     mViewTargets(xi_resource) {
+                mParentCount = std::tuple_size<std::tuple<Args...>>::value;
+            }
 
             // destructor
             ~TaskNode() noexcept = default;
 
             /**
-            * \brief declare node's parent (where parent output is not current node input's)
+            * \brief execute node's task and deliver its result to the connected descendant arguments:
+            *        a single 'by value' consumer gets the result moved into its argument, several consumers
+            *        share one immutable view of it (and 'by value' consumers get copies).
+            *        if nothing is connected, the result is kept (see 'getValue').
             *
-            * @param {ParentTask, in} current node parent
-            **/
-            template<typename ParentTask>
-            void setParent(ParentTask& xi_parent) {
-                updateParentCount();
-                SubscribeNoArgCallback cb = std::bind(static_cast<void(TaskNode::*)(void)>(&TaskNode::onArgumentReady), this);
-                xi_parent.addChild(cb);
-                xi_parent.mDescendants.emplace_back(this);
-            }
-
-            /**
-            * \brief execute node's task and call all the registered callbacks
-            *        throw if 'ReturnType' is not copyable but there is more than one descendant
-            *        that requires the result object.
+            * @param {bool, out} true (node is done once its task returns)
             **/
-            virtual void execute() override {
+            virtual bool execute() override {
                 // task doesn't return anything
                 if constexpr (std::is_void_v<ReturnType>) {
-                    if constexpr (!std::is_copy_constructible<decltype(mArguments)>::value) {
-                        std::apply(mTask, std::move(mArguments));
-                    } else {
-                        std::apply(mTask, mArguments);
-                    }
+                    invoke(std::index_sequence_for<Args...>{});
                 } // task return an argument
                 else {
-                    if constexpr (!std::is_copy_constructible<ReturnType>::value) {
-                        if (mDescendantTasks.size() > 1) {
-                            throw std::logic_error("cant have more than 1 descendant process for  anon-copyable object"); 
-                        }
-
-                        mResult = std::apply(mTask, std::move(mArguments));
-                        if (!mDescendantTasks.empty()) {
-                            mDescendantTasks[0](std::move(mResult.value()));
-                            mResult.reset();
+                    if constexpr (std::is_copy_constructible<ResultStorage>::value) {
+                        if (mMemo) {
+                            executeMemoized();
+                            return true;
                         }
                     }
-                    else {
-                        mResult = std::apply(mTask, mArguments);
-                        for (size_t i{}; i < mDescendantTasks.size(); ++i) {
-                            mDescendantTasks[i](mResult.value());
-                        }
-                    }
-                }
 
-                // call descendant's
-                for (auto childTask : mDescendantArguments) {
-                    childTask();
+                    deliver(invoke(std::index_sequence_for<Args...>{}));
                 }
 
-                // signal graph that task is complete
-                mGraph->onSingleNodeCompleted();
+                return true;
             }
 
             /**
-            * \brief get current node task output
+            * \brief memoize node result: before the task runs, a hash of its arguments is looked up in a cache, and on a hit
+            *        the cached result is delivered to descendants without running the task. a miss runs the task and caches its result.
+            *        the node gets a memoization domain of its own, so its results are never handed to another node
+            *        (to share results between nodes which compute the same function, memoize them in a shared domain).
+            *        the hash must cover everything the result depends on (including task captured state), equal hashes are taken as equal arguments.
+            *        memoized results are immutable - shared view consumers share the cached result, 'by value' consumers get a copy of it.
+            *
+            * @param {MemoCache, in} cache (must outlive node)
+            * @param {Hash,      in} argument hash - callable taking 'const ArgumentStorage&' and returning 'uint64_t'
+            * @param {Size,      in} result size - callable taking 'const ResultStorage&' and returning its size in bytes
+            *                        (optional, result type size is charged if omitted)
             **/
-            ReturnType getValue() {
-                if (!mResult) {
-                    throw std::logic_error("node has no result.");
-                }
+            template<typename Hash, typename Size = std::nullptr_t, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Hash>, MemoDomain>>>
+            void memoize(MemoCache& xi_cache, Hash&& xi_hash, Size&& xi_size = nullptr) {
+                memoize(xi_cache, makeMemoDomain(), std::forward<Hash>(xi_hash), std::forward<Size>(xi_size));
+            }
+
+            /**
+            * \brief memoize node result in a given domain: nodes (of any graph) memoized in the same domain share results,
+            *        so they must compute the same function of their arguments (and return the same type).
+            *
+            * @param {MemoCache,  in} cache (must outlive node)
+            * @param {MemoDomain, in} domain (see 'makeMemoDomain')
+            * @param {Hash,       in} argument hash - callable taking 'const ArgumentStorage&' and returning 'uint64_t'
+            * @param {Size,       in} result size - callable taking 'const ResultStorage&' and returning its size in bytes
+            *                         (optional, result type size is charged if omitted)
+            **/
+            template<typename Hash, typename Size = std::nullptr_t>
+            void memoize(MemoCache& xi_cache, MemoDomain xi_domain, Hash&& xi_hash, Size&& xi_size = nullptr) {
+                static_assert(!std::is_void_v<ReturnType>, "a task which does not return a result can not be memoized.");
+                static_assert(std::is_copy_constructible<ResultStorage>::value, "memoized result must be copyable.");
+                static_assert(std::is_convertible_v<std::invoke_result_t<Hash, const ArgumentStorage&>, std::uint64_t>, "argument hash must return an integer.");
 
-                if constexpr (!std::is_copy_constructible<ReturnType>::value) {
-                    return std::move(mResult.value());
-                } else {
-                    return mResult.value();
+                mMemo = std::make_unique<Memo>();
+                mMemo->mCache = &xi_cache;
+                mMemo->mDomain = xi_domain;
+                mMemo->mHash = std::forward<Hash>(xi_hash);
+                if constexpr (!std::is_null_pointer_v<std::decay_t<Size>>) {
+                    mMemo->mSize = std::forward<Size>(xi_size);
                 }
             }
 
+            // stop memoizing node result
+            void forget() noexcept { mMemo.reset(); }
+
+            // return true if node result is memoized
+            bool isMemoized() const noexcept { return static_cast<bool>(mMemo); }
+
             /**
-            * \brief add descendant to current node
-            *
-            * @param {SubscribeCallback, in} descendant callback function
+            * \brief get current node task output
+            *        (throws if result was moved to its single consumer)
             **/
-            void addChild(SubscribeNoArgCallback descendant) {
-                mDescendantArguments.push_back(descendant);
+            ReturnType getValue() {
+                if (mResult) {
+                    if constexpr (!std::is_copy_constructible<ReturnType>::value) {
+                        return std::move(mResult.value());
+                    } else {
+                        return mResult.value();
+                    }
+                }
+
+                if constexpr (std::is_copy_constructible<ReturnType>::value) {
+                    if (mView) {
+                        return *mView;
+                    }
+                }
+
+                throw std::logic_error("node has no result.");
             }
 
         // internals
         private:
 
             // properties
-            TaskCallback mTask;                                                                 // task callback
-            std::tuple<Args...> mArguments;                                                     // task arguments
-            std::optional<ResultStorage> mResult;                                               // task outcome
-            std::atomic<size_t> mPendingCount = std::tuple_size<std::tuple<Args...>>::value;    // amount of parents which are still in queue
-                                                                                                // (execute current task when this value is zero)
-            std::size_t mParentCount = std::tuple_size<std::tuple<Args...>>::value;             // how many parents this node has
-            std::vector<SubscribeCallback> mDescendantTasks;                                    // current node descendant's
-            std::vector<SubscribeNoArgCallback> mDescendantArguments;                           // current node descendant's arguments
-            TaskGraph* mGraph;                                                                  // pointer to task graph
+            TaskCallback mTask;                                         // task callback
+            ArgumentStorage mArguments;                                 // task arguments
+            std::optional<ResultStorage> mResult;                       // task outcome (when it is not consumed by descendants)
+            SharedView<ResultStorage> mView;                            // task outcome (when it is shared by descendants)
+            std::pmr::vector<ResultStorage*> mValueTargets;             // descendant arguments which take the result by value
+            std::pmr::vector<SharedView<ResultStorage>*> mViewTargets;  // descendant arguments which take a shared view of the result
+            std::uint64_t mConnected{};                                 // bit i is set if argument i is connected to a parent
 
-            // BaseTaskNode interface
-            virtual void reset() override { mResult.reset(); mPendingCount = mParentCount; }
-            virtual std::size_t getPendingCount() const final { return mPendingCount; }
+            // memoization settings
+            struct Memo {
+                MemoCache* mCache;                                              // result cache
+                MemoDomain mDomain;                                             // domain results are cached in
+                std::function<std::uint64_t(const ArgumentStorage&)> mHash;     // argument hash
+                std::function<std::size_t(const ResultStorage&)> mSize;         // result size (empty if result type size is charged)
+            };
+            std::unique_ptr<Memo> mMemo;                                // memoization settings (null if result is not memoized)
 
-            // increment parent count
-            void updateParentCount() {
-                ++mParentCount;
-                ++mPendingCount;
+            // invoke task (arguments held by value are moved into it, they are delivered again before next execution)
+            template<std::size_t... I>
+            ReturnType invoke(std::index_sequence<I...>) {
+                return std::invoke(mTask, static_cast<std::conditional_t<std::is_reference_v<Args>, Args, std::decay_t<Args>&&>>(std::get<I>(mArguments))...);
             }
 
-            /**
-            * \brief register a callback to be called when parent nodes have done their tasks
-            **/
-            void onArgumentReady() {
-                if (--mPendingCount == 0) {
-                    mGraph->executeSingleNode(this);
+            // pass task result to connected descendant arguments (or keep it)
+            void deliver(ResultStorage&& xi_result) {
+                mResult.reset();
+                mView.reset();
+
+                if (!mViewTargets.empty()) {
+                    if constexpr (std::is_copy_constructible<ResultStorage>::value) {
+                        for (ResultStorage* target : mValueTargets) {
+                            *target = xi_result;
+                        }
+                    }
+
+                    mView = std::make_shared<const ResultStorage>(std::move(xi_result));
+                    for (SharedView<ResultStorage>* target : mViewTargets) {
+                        *target = mView;
+                    }
+                }
+                else if (!mValueTargets.empty()) {
+                    if constexpr (std::is_copy_constructible<ResultStorage>::value) {
+                        // result is kept for later incremental executions, so every consumer gets a copy
+                        if (mKeepResult) {
+                            mResult = std::move(xi_result);
+                            for (ResultStorage* target : mValueTargets) {
+                                *target = *mResult;
+                            }
+                            return;
+                        }
+
+                        for (std::size_t i{ 1 }; i < mValueTargets.size(); ++i) {
+                            *mValueTargets[i] = xi_result;
+                        }
+                    }
+                    *mValueTargets[0] = std::move(xi_result);
+                }
+                else {
+                    mResult = std::move(xi_result);
+                }
+            }
+
+            // look task result up in memoization cache, run task (and cache its result) on a miss
+            void executeMemoized() {
+                const std::uint64_t hash{ mMemo->mHash(std::as_const(mArguments)) };
+                if (SharedView<ResultStorage> cached{ mMemo->mCache->template find<ResultStorage>(hash, mMemo->mDomain) }) {
+                    publish(cached);
+                    return;
+                }
+
+                SharedView<ResultStorage> result{ std::make_shared<const ResultStorage>(invoke(std::index_sequence_for<Args...>{})) };
+                mMemo->mCache->insert(hash, mMemo->mDomain, result, mMemo->mSize ? mMemo->mSize(*result) : sizeof(ResultStorage));
+                publish(result);
+            }
+
+            // pass a memoized (immutable) result to connected descendant arguments (or keep it)
+            void publish(const SharedView<ResultStorage>& xi_result) {
+                if (mViewTargets.empty()) {
+                    deliver(ResultStorage(*xi_result));
+                    return;
+                }
+
+                mResult.reset();
+                mView = xi_result;
+                for (ResultStorage* target : mValueTargets) {
+                    *target = *mView;
+                }
+                for (SharedView<ResultStorage>* target : mViewTargets) {
+                    *target = mView;
+                }
+            }
+
+            // BaseTaskNode interface
+            virtual void reset() override {
+                mResult.reset();
+                mView.reset();
+            }
+
+            // deliver kept result again (a result moved to its single consumer is not kept)
+            virtual bool redeliver() override {
+                if constexpr (!std::is_void_v<ReturnType>) {
+                    if (mValueTargets.empty() && mViewTargets.empty()) {
+                        return true;
+                    }
+
+                    if constexpr (std::is_copy_constructible<ResultStorage>::value) {
+                        const ResultStorage* result{ mResult ? &mResult.value() : mView.get() };
+                        if (!result) {
+                            return false;
+                        }
+
+                        for (ResultStorage* target : mValueTargets) {
+                            *target = *result;
+                        }
+                    }
+                    else if (!mView || !mValueTargets.empty()) {
+                        return false;
+                    }
+
+                    for (SharedView<ResultStorage>* target : mViewTargets) {
+                        *target = mView;
+                    }
                 }
+
+                return true;
             }
     };
 };
\ No newline at end of file
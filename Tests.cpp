@@ -6,6 +6,8 @@
 // This is an open source non-commercial project. Dear PVS-Studio, please check it.
 // PVS-Studio Static Code Analyzer for C, C++, C#, and Java: http://www.viva64.com
 #include "TaskGraph.h"
+#include "Pipeline.h"
+#include "StaticTaskGraph.h"
 
 // for test purposes
 #include <string>
@@ -14,6 +16,35 @@
 #include <vector>
 #include <numeric>
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <chrono>
+
+// count heap allocations (used to check that graph execution does not allocate)
+static std::atomic<std::size_t> allocations{};
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    ++allocations;
+    if (void* ptr = std::malloc(size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
 
 // simple ordered task graph using one thread 
 // task1 -> task3 -> task2 -> task4
@@ -62,11 +93,7 @@ void Test2() {
     BabyTask::TaskGraph task_graph;
 
     // tasks
-    std::function<int()> first = [&num]() -> int { num = 0;  return 13; };
-    auto task1 = task_graph.makeTaskNode(first);
-    // can't use: auto task1 = task_graph.makeTaskNode([&num]() -> int { num = 0;  return 13; });
-    // since compiler will deduce it to be std::function<void()>
-
+    auto task1 = task_graph.makeTaskNode([&num]() -> int { num = 0;  return 13; });
     auto task2 = task_graph.makeTaskNode([&num]() -> void { num = 1; });
     auto task3 = task_graph.makeTaskNode([&num]() -> void { num += 2; });
     auto task4 = task_graph.makeTaskNode([&num]() -> void { num *= 2; });
@@ -148,11 +175,1784 @@ void Test3() {
     assert(std::abs(static_cast<std::int32_t>(average * 10)) == 5);
 }
 
+// work stealing thread pool:
+// every task spawns two sub tasks (from within a pool worker) until a given depth is reached,
+// i.e. - a binary tree of tasks which is spread across workers by stealing
+void Test4() {
+
+    // locals
+    std::atomic<std::size_t> count{};
+    constexpr std::size_t depth{ 14 };
+
+    {
+        // thread pool (4 threads, work stealing)
+        BabyTask::ThreadPool pool(4, BabyTask::SchedulingPolicy::WorkStealing);
+
+        std::function<void(std::size_t, std::size_t)> spawn = [&](std::size_t, std::size_t level) {
+            ++count;
+            if (level < depth) {
+                pool.push(spawn, level + 1);
+                pool.push(spawn, level + 1);
+            }
+        };
+
+        pool.push(spawn, 1);
+
+        // wait for the whole tree to finish
+        while (count < (std::size_t{ 1 } << depth) - 1) {
+            std::this_thread::yield();
+        }
+    }
+
+    // check
+    assert(count == (std::size_t{ 1 } << depth) - 1);
+}
+
+// lock free bounded queue:
+// single thread push/pop/bulk semantics, then several producers and consumers checking that every element arrives once,
+// then a pool on top of it whose worker overflows the queue
+void Test5() {
+
+    // bounded queue (capacity is rounded up to 8)
+    BabyTask::BoundedQueue<int> queue(5);
+    assert(queue.capacity() == 8);
+    assert(queue.empty());
+
+    // fill it
+    int elements[10]{ 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+    assert(queue.push(elements[0]));
+    assert(queue.push_bulk(elements + 1, 9) == 7);
+    assert(!queue.push(100));
+
+    // drain it (in order)
+    int out[10]{};
+    int first{ -1 };
+    assert(queue.pop(first) && (first == 0));
+    assert(queue.pop_bulk(out, 10) == 7);
+    for (int i{}; i < 7; ++i) {
+        assert(out[i] == i + 1);
+    }
+    assert(!queue.pop(first));
+    assert(queue.empty());
+
+    // multi producer / multi consumer
+    BabyTask::BoundedQueue<std::size_t> mpmc(64);
+    constexpr std::size_t count{ 20'000 };
+    std::atomic<std::size_t> sum{}, popped{};
+    std::vector<std::thread> threads;
+
+    for (std::size_t p{}; p < 4; ++p) {
+        threads.emplace_back([&mpmc, p]() {
+            for (std::size_t i{ p }; i < count; i += 4) {
+                while (!mpmc.push(i + 1)) std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&mpmc, &sum, &popped]() {
+            std::size_t batch[8];
+            while (popped < count) {
+                const std::size_t len{ mpmc.pop_bulk(batch, 8) };
+                for (std::size_t i{}; i < len; ++i) {
+                    sum += batch[i];
+                }
+                popped += len;
+                if (len == 0) std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // check
+    assert(sum == count * (count + 1) / 2);
+
+    // thread pool running on top of the lock free queue
+    std::atomic<std::size_t> executed{};
+    {
+        BabyTask::LockFreeThreadPool pool(2);
+        for (std::size_t i{}; i < 5'000; ++i) {
+            pool.push([&executed](std::size_t) { ++executed; });
+        }
+    }
+    assert(executed == 5'000);
+
+    // a pool worker pushing more tasks than the queue holds spills them (instead of running them inline)
+    std::atomic<std::size_t> spilled{};
+    std::atomic<std::size_t> depth{}, maxDepth{};
+    {
+        BabyTask::LockFreeThreadPool pool(1);
+        pool.push([&pool, &spilled, &depth, &maxDepth](std::size_t) {
+            for (std::size_t i{}; i < 5'000; ++i) {
+                pool.push([&spilled, &depth, &maxDepth](std::size_t) {
+                    const std::size_t current{ ++depth };
+                    if (current > maxDepth) maxDepth = current;
+                    ++spilled;
+                    --depth;
+                });
+            }
+        }).wait();
+        while (spilled < 5'000) {
+            std::this_thread::yield();
+        }
+    }
+    assert(spilled == 5'000);
+    assert(maxDepth == 1);
+
+    // a full queue of a pool without workers is an error (rather than waiting forever)
+    BabyTask::LockFreeThreadPool idle;
+    bool thrown{ false };
+    try {
+        for (std::size_t i{}; i < 2'000; ++i) {
+            idle.push([](std::size_t) {});
+        }
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// allocation free execution:
+// once a graph has been executed, executing it again does not allocate
+// (tasks are held in recycled slots and submitted without a future)
+void Test6() {
+
+    // task graph (4 threads)
+    BabyTask::TaskGraph task_graph(4);
+
+    // locals
+    std::atomic<std::size_t> count{};
+
+    // 1 -> 32 -> 1
+    auto first = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    auto last = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    for (std::size_t i{}; i < 32; ++i) {
+        auto middle = task_graph.makeTaskNode([&count]() -> void { ++count; });
+        middle->setParent(*first);
+        last->setParent(*middle);
+    }
+
+    // every worker runs a node once (each of these nodes waits until all workers run one of them), so per thread
+    // state (such as trace buffers) is created here even if idle workers spin and a few of them take all the work
+    {
+        BabyTask::TaskGraph warm_up(task_graph.getExecutor());
+        std::atomic<std::size_t> arrived{};
+        for (std::size_t i{}; i < 4; ++i) {
+            warm_up.makeTaskNode([&arrived]() {
+                ++arrived;
+                while (arrived < 4) {
+                    std::this_thread::yield();
+                }
+            });
+        }
+        warm_up.execute();
+    }
+
+    // warm up (slots, deques and thread locals are created here)
+    for (std::size_t i{}; i < 10; ++i) {
+        task_graph.execute();
+        task_graph.reset();
+    }
+
+    // execute (must not allocate)
+    const std::size_t before{ allocations };
+    for (std::size_t i{}; i < 100; ++i) {
+        task_graph.execute();
+        task_graph.reset();
+    }
+    const std::size_t after{ allocations };
+
+    // check
+    assert(count == 110 * 34);
+    assert(after == before);
+
+    // small tasks are held inline, large tasks on the heap
+    std::array<char, 256> large{};
+    BabyTask::Task small([&count](std::size_t) { ++count; });
+    BabyTask::Task big([&count, large](std::size_t id) { count += large.size() + id; });
+    BabyTask::Task moved(std::move(big));
+    assert(small && moved && !big);
+    small(0);
+    moved(1);
+    assert(count == 110 * 34 + 1 + 257);
+}
+
+// inline continuation:
+// a long chain is executed by a single worker (the ready descendant runs inline, in a loop),
+// for every inline depth cap (zero disables inline execution)
+void Test7() {
+
+    for (std::size_t cap : { std::size_t{ 0 }, std::size_t{ 3 }, std::size_t{ 64 }, std::size_t{ 1'000'000 } }) {
+
+        // task graph (4 threads)
+        BabyTask::TaskGraph task_graph(4);
+        task_graph.setMaxInlineDepth(cap);
+        assert(task_graph.getMaxInlineDepth() == cap);
+
+        // chain of 20,000 nodes, each checks it runs after its parent
+        std::size_t step{};
+        bool ordered{ true };
+        BabyTask::BaseTaskNode* previous = task_graph.makeTaskNode([&step]() -> void { step = 1; });
+        for (std::size_t i{ 1 }; i < 20'000; ++i) {
+            auto current = task_graph.makeTaskNode([&step, &ordered, i]() -> void {
+                ordered &= (step == i);
+                step = i + 1;
+            });
+            current->setParent(*previous);
+            previous = current;
+        }
+
+        // execute
+        task_graph.execute();
+
+        // check
+        assert(ordered);
+        assert(step == 20'000);
+    }
+}
+
+// compiled graph:
+// a compiled graph is executed again and again without reset, and recompiled once its structure changes.
+// a graph with a cycle can not be compiled.
+void Test8() {
+
+    // task graph (2 threads)
+    BabyTask::TaskGraph task_graph(2);
+
+    // locals
+    std::atomic<std::size_t> count{};
+
+    // diamond
+    auto task1 = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    auto task2 = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    auto task3 = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    auto task4 = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    task2->setParent(*task1);
+    task3->setParent(*task1);
+    task4->setParent(*task2);
+    task4->setParent(*task3);
+
+    // compile
+    assert(!task_graph.isCompiled());
+    task_graph.compile();
+    assert(task_graph.isCompiled());
+    assert(task_graph.getPendingCount(*task4) == 2);
+
+    // execute several times
+    for (std::size_t i{}; i < 1'000; ++i) {
+        task_graph.execute();
+    }
+    assert(count == 4'000);
+    assert(task_graph.getPendingCount(*task4) == 0);
+
+    // change structure
+    auto task5 = task_graph.makeTaskNode([&count]() -> void { ++count; });
+    task5->setParent(*task4);
+    assert(!task_graph.isCompiled());
+    task_graph.execute();
+    assert(count == 4'005);
+
+    // cycle
+    task1->setParent(*task5);
+    bool thrown{ false };
+    try {
+        task_graph.compile();
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+}
+
+// asynchronous execution:
+// several graphs are started and only then waited on, a graph can not be started twice
+void Test9() {
+
+    // graphs (2 threads each)
+    constexpr std::size_t graphs{ 4 };
+    std::vector<std::unique_ptr<BabyTask::TaskGraph>> task_graphs;
+    std::vector<std::atomic<std::size_t>> counts(graphs);
+
+    for (std::size_t g{}; g < graphs; ++g) {
+        task_graphs.emplace_back(std::make_unique<BabyTask::TaskGraph>(2));
+        auto& count = counts[g];
+
+        // chain of 1,000 nodes
+        BabyTask::BaseTaskNode* previous = task_graphs[g]->makeTaskNode([&count]() -> void { ++count; });
+        for (std::size_t i{ 1 }; i < 1'000; ++i) {
+            auto current = task_graphs[g]->makeTaskNode([&count]() -> void { ++count; });
+            current->setParent(*previous);
+            previous = current;
+        }
+    }
+
+    // start all graphs
+    std::vector<BabyTask::TaskGraph::ExecutionHandle> handles;
+    for (auto& task_graph : task_graphs) {
+        handles.push_back(task_graph->executeAsync());
+    }
+
+    // a graph which is being executed can not be started again
+    bool thrown{ false };
+    try {
+        task_graphs[0]->executeAsync().wait();
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown || handles[0].ready());
+
+    // wait for all graphs
+    for (auto& handle : handles) {
+        handle.wait();
+        assert(handle.ready());
+    }
+
+    // check
+    for (std::size_t g{}; g < graphs; ++g) {
+        assert(counts[g] == (((g == 0) && !thrown) ? 2'000 : 1'000));
+    }
+}
+
+// shared executor:
+// many graphs run on one executor, and a short graph started after a long one is not starved by it
+void Test10() {
+
+    // executor (1 thread)
+    auto executor = std::make_shared<BabyTask::Executor>(1);
+    assert(executor->size() == 1);
+
+    // long graph - a chain of 5,000 busy nodes, each pushed to the pool (no inline execution)
+    BabyTask::TaskGraph long_graph(executor);
+    long_graph.setMaxInlineDepth(0);
+    std::atomic<std::size_t> count{};
+    auto busy = [&count]() -> void {
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::microseconds(5)) {}
+        ++count;
+    };
+    auto previous = long_graph.makeTaskNode(busy);
+    for (std::size_t i{ 1 }; i < 5'000; ++i) {
+        auto current = long_graph.makeTaskNode(busy);
+        current->setParent(*previous);
+        previous = current;
+    }
+
+    // short graph
+    BabyTask::TaskGraph short_graph(executor);
+    bool done{ false };
+    short_graph.makeTaskNode([&done]() -> void { done = true; });
+
+    // start long graph and then short graph
+    auto long_handle = long_graph.executeAsync();
+    auto short_handle = short_graph.executeAsync();
+
+    // short graph finishes long before long graph
+    short_handle.wait();
+    assert(done);
+    assert(!long_handle.ready());
+    long_handle.wait();
+    assert(count == 5'000);
+
+    // many graphs on a default (hardware concurrency) executor
+    auto shared = std::make_shared<BabyTask::Executor>();
+    assert(shared->size() == BabyTask::Executor::defaultConcurrency());
+    std::vector<std::unique_ptr<BabyTask::TaskGraph>> task_graphs;
+    std::atomic<std::size_t> total{};
+    for (std::size_t g{}; g < 16; ++g) {
+        task_graphs.emplace_back(std::make_unique<BabyTask::TaskGraph>(shared));
+        auto first = task_graphs[g]->makeTaskNode([&total]() -> void { ++total; });
+        for (std::size_t i{}; i < 8; ++i) {
+            auto child = task_graphs[g]->makeTaskNode([&total]() -> void { ++total; });
+            child->setParent(*first);
+        }
+    }
+
+    for (std::size_t run{}; run < 10; ++run) {
+        std::vector<BabyTask::TaskGraph::ExecutionHandle> handles;
+        for (auto& task_graph : task_graphs) {
+            handles.push_back(task_graph->executeAsync());
+        }
+        for (auto& handle : handles) {
+            handle.wait();
+        }
+    }
+    assert(total == 10 * 16 * 9);
+}
+
+// streaming pipeline:
+// parse (serial) -> transform (parallel) -> aggregate (serial, in order), with a bounded amount of tokens in flight,
+// then stages and a source which throw
+void Test11() {
+    struct Record {
+        std::size_t mInput;
+        std::size_t mValue;
+    };
+
+    auto executor = std::make_shared<BabyTask::Executor>(4);
+    BabyTask::Pipeline<Record> pipeline(executor, 8);
+
+    std::atomic<std::size_t> inFlight{}, maxInFlight{};
+    std::vector<std::size_t> aggregated;
+
+    pipeline.addStage(BabyTask::StageMode::SerialInOrder, [&inFlight, &maxInFlight](Record& record) {
+                const std::size_t current{ ++inFlight };
+                std::size_t previous{ maxInFlight };
+                while ((previous < current) && !maxInFlight.compare_exchange_weak(previous, current)) {}
+                record.mValue = record.mInput;
+            })
+            .addStage(BabyTask::StageMode::Parallel, [](Record& record) {
+                record.mValue *= record.mValue;
+            })
+            .addStage(BabyTask::StageMode::SerialInOrder, [&inFlight, &aggregated](Record& record) {
+                aggregated.push_back(record.mValue);
+                --inFlight;
+            });
+    assert(pipeline.size() == 3);
+    assert(pipeline.tokens() == 8);
+
+    for (std::size_t run{}; run < 2; ++run) {
+        aggregated.clear();
+        std::size_t input{};
+        const std::size_t count{ pipeline.run([&input](Record& record) -> bool {
+            if (input == 10'000) return false;
+            record.mInput = input++;
+            return true;
+        }) };
+
+        assert(count == 10'000);
+        assert(aggregated.size() == 10'000);
+        for (std::size_t i{}; i < aggregated.size(); ++i) {
+            assert(aggregated[i] == i * i);
+        }
+        assert(maxInFlight <= 8);
+    }
+
+    // empty stream
+    assert(pipeline.run([](Record&) -> bool { return false; }) == 0);
+
+    // a throwing stage stops the source and its exception is rethrown by run (the pipeline is reusable afterwards)
+    BabyTask::Pipeline<Record> failing(executor, 8);
+    std::atomic<std::size_t> ordered{};
+    failing.addStage(BabyTask::StageMode::Parallel, [](Record& record) {
+                if (record.mInput == 100) throw std::runtime_error("bad record");
+            })
+            .addStage(BabyTask::StageMode::SerialInOrder, [&ordered](Record&) { ++ordered; });
+
+    for (std::size_t run{}; run < 2; ++run) {
+        std::size_t input{};
+        bool thrown{ false };
+        try {
+            failing.run([&input](Record& record) -> bool {
+                if (input == 10'000) return false;
+                record.mInput = input++;
+                return true;
+            });
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(input < 10'000);
+    }
+
+    // so does a throwing source
+    bool thrown{ false };
+    try {
+        pipeline.run([](Record&) -> bool { throw std::runtime_error("bad input"); });
+    }
+    catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    ordered = 0;
+    std::size_t input{};
+    assert(failing.run([&input](Record& record) -> bool {
+        if (input == 50) return false;
+        record.mInput = input++;
+        return true;
+    }) == 50);
+    assert(ordered == 50);
+}
+
+// parallel for and parallel reduce nodes:
+// Test3 with the 9M element fill and min/max search split across workers
+void Test12() {
+
+    // task graph (4 threads)
+    BabyTask::TaskGraph task_graph(4);
+
+    // locals
+    constexpr std::int64_t count{ 9'000'000 };
+    std::vector<float> n0(count), n1(count);
+    float average{ 35.13f };
+
+    // fill n0 & n1 (automatic grain size)
+    auto fill0 = task_graph.makeParallelForNode(std::int64_t{}, count, 0, [&n0](std::int64_t i) { n0[i] = static_cast<float>(i) - 4'500'000.0f; });
+    auto fill1 = task_graph.makeParallelForNode(std::int64_t{}, count, 0, [&n1](std::int64_t i) { n1[i] = static_cast<float>(i) - 4'500'000.0f; });
+
+    // n0 min & n1 max
+    auto min0 = task_graph.makeParallelReduceNode(std::int64_t{}, count, 10'000, std::numeric_limits<float>::max(),
+                                                  [&n0](std::int64_t begin, std::int64_t end, float partial) -> float {
+                                                      return std::min(partial, *std::min_element(n0.begin() + begin, n0.begin() + end));
+                                                  },
+                                                  [](float a, float b) -> float { return std::min(a, b); });
+    auto max1 = task_graph.makeParallelReduceNode(std::int64_t{}, count, 10'000, std::numeric_limits<float>::lowest(),
+                                                  [&n1](std::int64_t begin, std::int64_t end, float partial) -> float {
+                                                      return std::max(partial, *std::max_element(n1.begin() + begin, n1.begin() + end));
+                                                  },
+                                                  [](float a, float b) -> float { return std::max(a, b); });
+
+    // average
+    auto result = task_graph.makeTaskNode([&average, min0, max1]() -> void {
+        average = min0->getValue() + 0.5f * (max1->getValue() - min0->getValue());
+    });
+
+    min0->setParent(*fill0);
+    max1->setParent(*fill1);
+    result->setParent(*min0);
+    result->setParent(*max1);
+
+    for (std::size_t run{}; run < 3; ++run) {
+        average = 35.13f;
+        task_graph.execute();
+        assert(min0->getValue() == -4'500'000.0f);
+        assert(max1->getValue() == 4'499'999.0f);
+        assert(std::abs(static_cast<std::int32_t>(average * 10)) == 5);
+    }
+
+    // uneven work (cost grows with index) and every index visited exactly once
+    BabyTask::TaskGraph uneven_graph(4);
+    std::vector<std::atomic<std::uint32_t>> visits(20'000);
+    auto uneven = uneven_graph.makeParallelForNode(0, 20'000, 16, [&visits](int i) {
+        volatile std::uint64_t sink{};
+        for (int j{}; j < i / 8; ++j) sink = sink + static_cast<std::uint64_t>(j);
+        ++visits[i];
+    });
+    auto sum = uneven_graph.makeParallelReduceNode(0, 20'000, 1, std::size_t{},
+                                                   [&visits](int begin, int end, std::size_t partial) -> std::size_t {
+                                                       for (int i{ begin }; i < end; ++i) partial += visits[i];
+                                                       return partial;
+                                                   },
+                                                   [](std::size_t a, std::size_t b) -> std::size_t { return a + b; });
+    sum->setParent(*uneven);
+    uneven_graph.execute();
+    assert(sum->getValue() == 20'000);
+    assert(std::all_of(visits.begin(), visits.end(), [](const auto& v) { return v == 1; }));
+
+    // empty range
+    auto empty = uneven_graph.makeParallelReduceNode(5, 5, 0, 7, [](int, int, int partial) -> int { return partial + 1; }, [](int a, int b) -> int { return a + b; });
+    uneven_graph.execute();
+    assert(empty->getValue() == 7);
+
+    // a range which fits one grain is processed by the executing worker alone (no helper is submitted)
+    BabyTask::TaskGraph small_graph(4);
+    std::atomic<std::size_t> chunks{};
+    auto single = small_graph.makeParallelForNode(0, 64, 64, [&chunks](int i) { if (i == 0) ++chunks; });
+    auto tiny = small_graph.makeParallelReduceNode(0, 256, 1, std::size_t{},
+                                                   [](int begin, int end, std::size_t partial) -> std::size_t {
+                                                       for (int i{ begin }; i < end; ++i) partial += static_cast<std::size_t>(i);
+                                                       return partial;
+                                                   },
+                                                   [](std::size_t a, std::size_t b) -> std::size_t { return a + b; });
+    tiny->setParent(*single);
+
+    // helpers which are dequeued after the node has finished do not join a later execution of it
+    for (std::size_t run{}; run < 500; ++run) {
+        small_graph.execute();
+        assert(tiny->getValue() == 255 * 256 / 2);
+    }
+    assert(chunks == 500);
+}
+
+// typed data flow edges:
+// a single consumer gets the result moved into its argument, several consumers share one immutable view
+void Test13() {
+
+    // task graph (2 threads)
+    BabyTask::TaskGraph task_graph(2);
+
+    // locals
+    const float* produced{};
+    const float* sharedProduced{};
+    bool moved{ false };
+    std::atomic<std::size_t> shared{};
+
+    // producers
+    std::function<std::vector<float>()> produce = [&produced]() -> std::vector<float> {
+        std::vector<float> buffer(1'000'000, 1.0f);
+        produced = buffer.data();
+        return buffer;
+    };
+    std::function<std::vector<float>()> produceShared = [&sharedProduced]() -> std::vector<float> {
+        std::vector<float> buffer(1'000'000, 1.0f);
+        sharedProduced = buffer.data();
+        return buffer;
+    };
+    auto producer = task_graph.makeTaskNode(produce);
+    auto sharedProducer = task_graph.makeTaskNode(produceShared);
+
+    // single consumer (by value, buffer is not copied)
+    std::function<void(std::vector<float>)> consume = [&produced, &moved](std::vector<float> buffer) -> void {
+        moved = (buffer.data() == produced) && (buffer.size() == 1'000'000);
+    };
+    auto consumer = task_graph.makeTaskNode(consume);
+    task_graph.connect<0>(*producer, *consumer);
+
+    // three consumers of a shared view (buffer is not copied)
+    std::function<void(BabyTask::SharedView<std::vector<float>>)> view = [&sharedProduced, &shared](BabyTask::SharedView<std::vector<float>> buffer) -> void {
+        if (buffer && (buffer->data() == sharedProduced)) ++shared;
+    };
+    for (std::size_t i{}; i < 3; ++i) {
+        auto viewer = task_graph.makeTaskNode(view);
+        task_graph.connect<0>(*sharedProducer, *viewer);
+    }
+
+    // two arguments from two producers
+    std::function<int()> left = []() -> int { return 3; };
+    std::function<int()> right = []() -> int { return 4; };
+    std::function<int(int, const int&)> add = [](int a, const int& b) -> int { return a + b; };
+    auto leftNode = task_graph.makeTaskNode(left);
+    auto rightNode = task_graph.makeTaskNode(right);
+    auto addNode = task_graph.makeTaskNode(add);
+    task_graph.connect<0>(*leftNode, *addNode);
+    task_graph.connect<1>(*rightNode, *addNode);
+
+    // non copyable result
+    std::function<std::unique_ptr<int>()> make = []() -> std::unique_ptr<int> { return std::make_unique<int>(42); };
+    std::function<int(std::unique_ptr<int>)> take = [](std::unique_ptr<int> value) -> int { return *value; };
+    auto maker = task_graph.makeTaskNode(make);
+    auto taker = task_graph.makeTaskNode(take);
+    auto otherTaker = task_graph.makeTaskNode(take);
+    task_graph.connect<0>(*maker, *taker);
+
+    // connecting an argument twice / passing a non copyable result to two consumers throws
+    bool thrown{ false };
+    try { task_graph.connect<0>(*leftNode, *addNode); } catch (const std::logic_error&) { thrown = true; }
+    assert(thrown);
+    thrown = false;
+    try { task_graph.connect<0>(*maker, *otherTaker); } catch (const std::logic_error&) { thrown = true; }
+    assert(thrown);
+    task_graph.connect<0>(*task_graph.makeTaskNode(make), *otherTaker);
+
+    for (std::size_t run{}; run < 2; ++run) {
+        moved = false;
+        shared = 0;
+        task_graph.execute();
+
+        assert(moved);
+        assert(shared == 3);
+        assert(sharedProducer->getValue().size() == 1'000'000);
+        assert(addNode->getValue() == 7);
+        assert(taker->getValue() == 42);
+        assert(otherTaker->getValue() == 42);
+
+        // result was moved to its single consumer
+        thrown = false;
+        try { producer->getValue(); } catch (const std::logic_error&) { thrown = true; }
+        assert(thrown);
+    }
+}
+
+// static task graph:
+// topology known at compile time, executed in parallel and sequentially, and a task which throws
+void Test14() {
+    using namespace BabyTask;
+
+    //          --> 1 --
+    //         |        |
+    //     0 ---        ---> 3 ---> 4
+    //         |        |
+    //          --> 2 --
+    using DiamondEdges = Edges<Edge<0, 1>, Edge<0, 2>, Edge<1, 3>, Edge<2, 3>, Edge<3, 4>>;
+    using Topology = StaticTopology<5, DiamondEdges>;
+    static_assert(Topology::Pending[0] == 0 && Topology::Pending[3] == 2 && Topology::Pending[4] == 1);
+    static_assert(Topology::SourceCount == 1 && Topology::Sources[0] == 0);
+    static_assert(Topology::Offsets[1] - Topology::Offsets[0] == 2);
+    static_assert(Topology::TopologicalOrder.mNodes[0] == 0 && Topology::TopologicalOrder.mNodes[4] == 4);
+
+    int value{}, left{}, right{};
+    std::atomic<int> order{};
+    std::array<int, 5> stamp{};
+    auto graph = makeStaticTaskGraph<DiamondEdges>(std::make_shared<Executor>(4),
+                                                   [&]() { value = 1;  stamp[0] = order++; },
+                                                   [&]() { left = value + 2;  stamp[1] = order++; },
+                                                   [&]() { right = value + 3; stamp[2] = order++; },
+                                                   [&]() { value = left * right; stamp[3] = order++; },
+                                                   [&]() { value -= 1; stamp[4] = order++; });
+    static_assert(decltype(graph)::size() == 5);
+
+    for (std::size_t run{}; run < 1'000; ++run) {
+        order = 0;
+        graph.execute();
+        assert(value == 11);
+        assert((stamp[0] < stamp[1]) && (stamp[0] < stamp[2]) && (stamp[1] < stamp[3]) && (stamp[2] < stamp[3]) && (stamp[3] < stamp[4]));
+    }
+
+    order = 0;
+    graph.executeSequential();
+    assert(value == 11);
+    assert(stamp[0] == 0 && stamp[4] == 4);
+
+    // a throwing task: its exception is rethrown by execute, and its descendants are skipped
+    bool poisoned{ true };
+    std::atomic<int> sinks{};
+    auto failing = makeStaticTaskGraph<DiamondEdges>(std::make_shared<Executor>(4),
+                                                     []() {},
+                                                     [&poisoned]() { if (poisoned) throw std::runtime_error("left"); },
+                                                     []() {},
+                                                     []() {},
+                                                     [&sinks]() { ++sinks; });
+    for (std::size_t run{}; run < 100; ++run) {
+        bool thrown{ false };
+        try {
+            failing.execute();
+        }
+        catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    assert(sinks == 0);
+
+    poisoned = false;
+    failing.execute();
+    assert(sinks == 1);
+}
+
+// callables are held by their own type:
+// result type is deduced, large captures and move only callables are held inside the node (in graph arena)
+int Twice(int x) { return 2 * x; }
+
+void Test15() {
+
+    // task graph (2 threads)
+    BabyTask::TaskGraph task_graph(2);
+
+    // lambda result type is deduced
+    auto task1 = task_graph.makeTaskNode([]() -> int { return 13; });
+    auto task2 = task_graph.makeTaskNode([]() { return std::string("BabyTask"); });
+    static_assert(std::is_same_v<decltype(task1->getValue()), int>);
+    static_assert(std::is_same_v<decltype(task2->getValue()), std::string>);
+
+    // move only & mutable callable
+    auto task3 = task_graph.makeTaskNode([value = std::make_unique<int>(5), calls = 0]() mutable -> int { return *value + calls++; });
+
+    // function pointer & std::function (arguments are deduced)
+    auto task4 = task_graph.makeTaskNode(&Twice);
+    std::function<int(int, int)> sum = [](int a, int b) -> int { return a + b; };
+    auto task5 = task_graph.makeTaskNode(sum);
+    task_graph.connect<0>(*task1, *task4);
+    task_graph.connect<0>(*task4, *task5);
+    task_graph.connect<1>(*task3, *task5);
+
+    task_graph.execute();
+    assert(task2->getValue() == "BabyTask");
+    assert(task5->getValue() == 26 + 5);
+
+    // large captures do not allocate (beyond the arena and node table growth)
+    std::array<char, 512> large{};
+    large[0] = 1;
+    std::atomic<std::size_t> total{};
+    BabyTask::TaskGraph large_graph(1);
+    const std::size_t before{ allocations };
+    for (std::size_t i{}; i < 1'000; ++i) {
+        large_graph.makeTaskNode([large, &total]() { total += static_cast<std::size_t>(large[0]); });
+    }
+    const std::size_t after{ allocations };
+    assert(after - before < 100);
+
+    large_graph.execute();
+    assert(total == 1'000);
+}
+
+// critical path priority scheduling:
+// a long chain is dispatched before short side branches which were declared (and became ready) before it
+void Test16() {
+
+    for (bool priority : { false, true }) {
+        // task graph (1 thread, so execution order is deterministic)
+        BabyTask::TaskGraph task_graph(1);
+        task_graph.setPriorityScheduling(priority);
+        assert(task_graph.getPriorityScheduling() == priority);
+
+        std::vector<int> order;
+
+        // 8 short side nodes
+        for (int i{}; i < 8; ++i) {
+            auto side = task_graph.makeTaskNode([&order, i]() { order.push_back(100 + i); });
+            task_graph.setCost(*side, 1.0f);
+        }
+
+        // a chain of 4 long nodes
+        BabyTask::BaseTaskNode* chain[4];
+        for (int i{}; i < 4; ++i) {
+            auto link = task_graph.makeTaskNode([&order, i]() { order.push_back(i); });
+            task_graph.setCost(*link, 100.0f);
+            if (i > 0) {
+                link->setParent(*chain[i - 1]);
+            }
+            chain[i] = link;
+        }
+
+        task_graph.execute();
+        assert(order.size() == 12);
+
+        if (priority) {
+            assert(task_graph.getRank(*chain[0]) == 400.0f);
+            assert(task_graph.getRank(*chain[3]) == 100.0f);
+            assert((order[0] == 0) && (order[1] == 1) && (order[2] == 2) && (order[3] == 3));
+        }
+        else {
+            assert(order[0] == 100);
+        }
+    }
+
+    // measured costs
+    BabyTask::TaskGraph task_graph(2);
+    task_graph.setPriorityScheduling(true);
+    auto spin = []() {
+        const auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::microseconds(200)) {}
+    };
+    auto heavy1 = task_graph.makeTaskNode(spin);
+    auto heavy2 = task_graph.makeTaskNode(spin);
+    auto light = task_graph.makeTaskNode([]() {});
+    heavy2->setParent(*heavy1);
+
+    task_graph.execute();
+    task_graph.execute();
+    assert(task_graph.getRank(*heavy1) >= 400.0f);
+    assert(task_graph.getRank(*heavy1) > task_graph.getRank(*heavy2));
+    assert(task_graph.getRank(*light) < task_graph.getRank(*heavy2));
+}
+
+// tracing:
+// events are recorded in per thread ring buffers and exported as Chrome trace JSON
+// (graph nodes are traced when compiled with BABYTASK_TRACING)
+void Test17() {
+    BabyTask::Tracer& tracer = BabyTask::Tracer::instance();
+    tracer.clear();
+
+    // record from several threads (more events than a ring buffer holds on the main thread)
+    const std::string_view name{ tracer.intern("record \"quoted\"") };
+    assert(name == tracer.intern(std::string("record \"quoted\"")));
+    std::vector<std::thread> threads;
+    for (std::uint32_t t{}; t < 3; ++t) {
+        threads.emplace_back([&tracer, name, t]() {
+            for (std::size_t i{}; i < 100; ++i) {
+                const std::uint64_t now{ BabyTask::Tracer::now() };
+                tracer.record(BabyTask::TraceEvent{ name, now, now, now + 10, t });
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (std::size_t i{}; i < 20'000; ++i) {
+        const std::uint64_t now{ BabyTask::Tracer::now() };
+        tracer.record(BabyTask::TraceEvent{ name, now, now, now, 7 });
+    }
+
+    const std::vector<BabyTask::TraceEvent> events{ tracer.collect() };
+    assert(events.size() == 300 + (std::size_t{ 1 } << 14));
+
+    std::ostringstream json;
+    tracer.writeChromeTrace(json);
+    const std::string trace{ json.str() };
+    assert(trace.find("{\"traceEvents\":[") == 0);
+    assert(trace.find("\"name\":\"record \\\"quoted\\\"\"") != std::string::npos);
+    assert(trace.find("\"tid\":2") != std::string::npos);
+    tracer.clear();
+    assert(tracer.collect().empty());
+
+#ifdef BABYTASK_TRACING
+    // graph execution
+    {
+        BabyTask::TaskGraph task_graph(2);
+        auto first = task_graph.makeTaskNode([]() {}, "first");
+        auto second = task_graph.makeTaskNode([]() {}, "second");
+        second->setParent(*first);
+        task_graph.execute();
+        task_graph.execute();
+    }
+
+    // names outlive the graph
+    const std::vector<BabyTask::TraceEvent> nodes{ tracer.collect() };
+    assert(nodes.size() == 4);
+    for (const auto& event : nodes) {
+        assert((event.mName == "first") || (event.mName == "second"));
+        assert((event.mReady <= event.mStart) && (event.mStart <= event.mEnd));
+        assert(event.mWorker < 2);
+    }
+    tracer.clear();
+#endif
+}
+
+// worker placement:
+// workers pinned by compact/scatter/explicit policies, per NUMA node queues and locality hints
+void Test18() {
+    // sysfs cpu list parsing
+    const std::vector<std::size_t> list{ BabyTask::CpuTopology::parseCpuList("0-3,8,10-11\n") };
+    assert((list == std::vector<std::size_t>{ 0, 1, 2, 3, 8, 10, 11 }));
+    assert(BabyTask::CpuTopology::parseCpuList("").empty());
+
+    // placement policies
+    const BabyTask::CpuTopology topology({ { 1, 0 }, {}, { 2, 3 } });
+    assert((topology.nodeCount() == 2) && (topology.cpuCount() == 4) && (topology.nodeOf(3) == 1));
+    const std::size_t compact[]{ 0, 1, 2, 3, 0 }, scatter[]{ 0, 2, 1, 3, 0 };
+    for (std::size_t i{}; i < 5; ++i) {
+        assert(topology.place({ BabyTask::AffinityPolicy::Compact, {} }, i).mCpu == compact[i]);
+        assert(topology.place({ BabyTask::AffinityPolicy::Scatter, {} }, i).mCpu == scatter[i]);
+        assert(topology.place({ BabyTask::AffinityPolicy::Scatter, {} }, i).mNode == i % 2);
+    }
+    const BabyTask::WorkerPlacement placement{ topology.place({ BabyTask::AffinityPolicy::Explicit, { 3, 0 } }, 0) };
+    assert(placement.mPinned && (placement.mCpu == 3) && (placement.mNode == 1));
+    assert(!topology.place({}, 0).mPinned);
+
+    // sysfs parsing (restricted to the cpus this process may use)
+    const std::vector<std::size_t> allowed{ BabyTask::allowedCpus() };
+    const std::filesystem::path root{ std::filesystem::temp_directory_path() / "babytask_topology" };
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "node2");
+    std::filesystem::create_directories(root / "node0");
+    std::filesystem::create_directories(root / "nodes");
+    std::ofstream(root / "node2" / "cpulist") << allowed.front() << "\n";
+    std::ofstream(root / "node0" / "cpulist") << "100000\n";
+    const BabyTask::CpuTopology parsed{ BabyTask::CpuTopology::fromSysfs(root) };
+    assert((parsed.nodeCount() == 1) && (parsed.cpus(0) == std::vector<std::size_t>{ allowed.front() }));
+    std::filesystem::remove_all(root);
+    assert(BabyTask::CpuTopology::fromSysfs(root).cpus(0) == allowed);
+    assert(BabyTask::CpuTopology::system().cpuCount() > 0);
+
+    // two fake NUMA nodes sharing one real cpu (so workers are really pinned even on a single cpu machine)
+    const std::size_t cpu{ allowed.front() };
+    const BabyTask::CpuTopology shared({ { cpu }, { cpu } });
+    auto executor = std::make_shared<BabyTask::Executor>(4, BabyTask::Placement{ BabyTask::AffinityPolicy::Scatter, {} }, shared);
+    assert((executor->nodeCount() == 2) && (executor->currentNode() == BabyTask::AnyNode));
+    assert((executor->pool().placement(1).mNode == 1) && (executor->pool().placement(2).mNode == 0));
+
+    std::atomic<std::size_t> count{}, unpinned{};
+    for (std::size_t i{}; i < 1000; ++i) {
+        executor->submit([&count, &unpinned, &executor, cpu](std::size_t id) {
+            if (executor->currentNode() != executor->pool().placement(id).mNode) ++unpinned;
+#ifdef __linux__
+            if (static_cast<std::size_t>(sched_getcpu()) != cpu) ++unpinned;
+#endif
+            ++count;
+        }, i % 3);
+    }
+    while (count < 1000) {
+        std::this_thread::yield();
+    }
+    assert(unpinned == 0);
+
+    // graph nodes with a locality hint
+    BabyTask::TaskGraph task_graph(executor);
+    std::vector<int> order;
+    BabyTask::BaseTaskNode* previous{};
+    for (int i{}; i < 100; ++i) {
+        auto node = task_graph.makeTaskNode([&order, i]() { order.push_back(i); });
+        task_graph.setLocality(*node, static_cast<std::size_t>(i % 2));
+        if (previous) node->setParent(*previous);
+        previous = node;
+    }
+    assert(task_graph.getLocality(*previous) == 1);
+    task_graph.execute();
+    task_graph.execute();
+    assert(order.size() == 200);
+    for (int i{}; i < 200; ++i) {
+        assert(order[i] == i % 100);
+    }
+}
+
+// idle workers:
+// spin, yield and then sleep on an eventcount (pushes skip notification when no worker sleeps)
+void Test19() {
+    // eventcount
+    {
+        BabyTask::EventCount event;
+        std::atomic<bool> ready{ false };
+        std::thread waiter([&event, &ready]() {
+            while (!ready) {
+                const BabyTask::EventCount::Key key{ event.prepareWait() };
+                if (ready) {
+                    event.cancelWait();
+                    break;
+                }
+                event.commitWait(key);
+            }
+        });
+        while (event.waiters() == 0) {
+            std::this_thread::yield();
+        }
+        ready = true;
+        event.notify();
+        waiter.join();
+        assert((event.waiters() == 0) && !event.notify());
+    }
+
+    // workers without a spin budget go to sleep right away, and are woken by pushes
+    {
+        BabyTask::ThreadPool pool(2, BabyTask::SchedulingPolicy::WorkStealing);
+        pool.setSpinBudget(0, 0);
+        assert((pool.spinCount() == 0) && (pool.yieldCount() == 0));
+        while (pool.idelCount() < 2) {
+            std::this_thread::yield();
+        }
+
+        std::atomic<int> count{};
+        for (int i{}; i < 100; ++i) {
+            pool.submit([&count](std::size_t) { ++count; });
+        }
+        while (count < 100) {
+            std::this_thread::yield();
+        }
+
+        const BabyTask::IdleStatistics statistics{ pool.idleStatistics() };
+        assert((statistics.mParks >= 2) && (statistics.mNotifications >= 1));
+        assert((statistics.mSpinHits == 0) && (statistics.mYieldHits == 0));
+    }
+
+    // a spinning worker picks up tasks, and pushes skip notification
+    {
+        BabyTask::ThreadPool pool(1, BabyTask::SchedulingPolicy::WorkStealing);
+        pool.setSpinBudget(1 << 16, 1 << 12);
+        std::atomic<int> count{};
+        for (int i{}; i < 20; ++i) {
+            pool.submit([&count](std::size_t) { ++count; });
+            while (count < i + 1) {
+                std::this_thread::yield();
+            }
+        }
+
+        const BabyTask::IdleStatistics statistics{ pool.idleStatistics() };
+        assert(statistics.mSpinHits + statistics.mYieldHits > 0);
+        assert(statistics.mSkippedNotifications > 0);
+    }
+}
+
+// dynamic subflows and nested graphs:
+// a subflow node builds a subgraph while it runs, a graph node executes a prebuilt graph,
+// and descendants of both start only once the inner graph has completed
+void Test20() {
+    auto executor = std::make_shared<BabyTask::Executor>(2);
+
+    // fan out known only at runtime (with a nested subflow)
+    {
+        BabyTask::TaskGraph task_graph(executor);
+        std::atomic<int> sum{}, nested{};
+        int chunks{}, total{};
+
+        auto header = task_graph.makeTaskNode([&chunks]() { chunks = 40; }, "header");
+        auto split = task_graph.makeSubflowNode([&chunks, &sum, &nested](BabyTask::Subflow& subflow) {
+            auto gather = subflow.makeTaskNode([&sum]() { sum += 1000; }, "gather");
+            for (int i{}; i < chunks; ++i) {
+                auto chunk = subflow.makeTaskNode([&sum, i]() { sum += i; });
+                gather->setParent(*chunk);
+            }
+
+            auto inner = subflow.makeSubflowNode([&nested](BabyTask::Subflow& innerflow) {
+                for (int i{}; i < 10; ++i) {
+                    innerflow.makeTaskNode([&nested]() { ++nested; });
+                }
+            });
+            inner->setParent(*gather);
+            assert(subflow.size() == static_cast<std::size_t>(chunks) + 2);
+        }, "split");
+        auto empty = task_graph.makeSubflowNode([](BabyTask::Subflow&) {});
+        auto merge = task_graph.makeTaskNode([&sum, &nested, &total]() { total = sum + nested; });
+        split->setParent(*header);
+        merge->setParent(*split);
+        merge->setParent(*empty);
+
+        for (int run{ 1 }; run <= 3; ++run) {
+            task_graph.execute();
+            assert(sum == run * (1000 + 39 * 40 / 2));
+            assert(nested == run * 10);
+            assert(total == sum + nested);
+        }
+        assert((split->getSubgraph() != nullptr) && (split->getSubgraph()->size() == 42));
+    }
+
+    // a prebuilt graph as one node
+    {
+        BabyTask::TaskGraph inner(executor);
+        std::vector<int> order;
+        std::mutex mutex;
+        auto record = [&order, &mutex](int value) {
+            std::unique_lock<std::mutex> lock(mutex);
+            order.push_back(value);
+        };
+
+        auto first = inner.makeTaskNode([&record]() { record(1); });
+        auto second = inner.makeTaskNode([&record]() { record(2); });
+        second->setParent(*first);
+
+        BabyTask::TaskGraph outer(executor);
+        auto before = outer.makeTaskNode([&record]() { record(0); });
+        auto nested = outer.makeGraphNode(inner, "inner");
+        auto after = outer.makeTaskNode([&record]() { record(3); });
+        nested->setParent(*before);
+        after->setParent(*nested);
+
+        outer.execute();
+        outer.execute();
+        assert((order == std::vector<int>{ 0, 1, 2, 3, 0, 1, 2, 3 }));
+        assert(&nested->getGraph() == &inner);
+
+        // nested graph can still be executed on its own
+        inner.execute();
+        assert(order.size() == 10);
+
+        bool thrown{ false };
+        try {
+            outer.makeGraphNode(outer);
+        }
+        catch (const std::invalid_argument&) {
+            thrown = true;
+        }
+        assert(thrown);
+
+        // a cleared graph is rebuilt from scratch
+        inner.clear();
+        assert(inner.size() == 0);
+        inner.makeTaskNode([&record]() { record(4); }, "rebuilt");
+        outer.execute();
+        assert(order.size() == 13 && order.back() == 3);
+    }
+}
+
+// condition nodes:
+// a condition node chooses which successor runs, nodes reachable only through untaken branches are skipped
+void Test21() {
+    BabyTask::TaskGraph task_graph(2);
+    int choice{};
+    std::atomic<int> fast{}, fallback{}, follow{}, join{}, parallel{};
+
+    auto validate = task_graph.makeTaskNode([]() {}, "validate");
+    auto condition = task_graph.makeConditionNode([&choice]() { return choice; }, "condition");
+    auto fastPath = task_graph.makeTaskNode([&fast]() { ++fast; }, "fast");
+    auto fallbackPath = task_graph.makeTaskNode([&fallback]() { ++fallback; }, "fallback");
+    auto fallbackFollow = task_graph.makeTaskNode([&follow]() { ++follow; });
+    auto fallbackParallel = task_graph.makeParallelForNode(0, 100, 1, [&parallel](int) { ++parallel; });
+    auto joined = task_graph.makeTaskNode([&join]() { ++join; }, "join");
+    condition->setParent(*validate);
+    fastPath->setParent(*condition);        // branch 0
+    fallbackPath->setParent(*condition);    // branch 1
+    fallbackFollow->setParent(*fallbackPath);
+    fallbackParallel->setParent(*fallbackPath);
+    joined->setParent(*fastPath);
+    joined->setParent(*fallbackFollow);
+    joined->setParent(*fallbackParallel);
+
+    // fast path only (the join is reachable through it)
+    task_graph.execute();
+    assert((fast == 1) && (fallback == 0) && (follow == 0) && (parallel == 0) && (join == 1));
+    assert(condition->getBranch() == 0);
+
+    // fallback path only
+    choice = 1;
+    task_graph.execute();
+    assert((fast == 1) && (fallback == 1) && (follow == 1) && (parallel == 100) && (join == 2));
+
+    // no branch (everything after the condition is skipped, graph still completes)
+    for (int value : { 2, -1 }) {
+        choice = value;
+        task_graph.execute();
+        assert((fast == 1) && (fallback == 1) && (follow == 1) && (parallel == 100) && (join == 2));
+        assert(condition->getBranch() == ((value < 0) ? BabyTask::NoBranch : std::size_t{ 2 }));
+    }
+
+    // a long skipped chain is released without recursion
+    BabyTask::TaskGraph chain_graph(1);
+    std::atomic<int> executed{};
+    auto branch = chain_graph.makeConditionNode([]() { return false; });
+    auto taken = chain_graph.makeTaskNode([&executed]() { ++executed; });
+    taken->setParent(*branch);
+    BabyTask::BaseTaskNode* previous{ branch };
+    for (int i{}; i < 100'000; ++i) {
+        auto node = chain_graph.makeTaskNode([&executed]() { ++executed; });
+        node->setParent(*previous);
+        previous = node;
+    }
+    chain_graph.execute();
+    assert(executed == 1);
+}
+
+// incremental execution:
+// only dirty nodes and their descendants run again, clean parents deliver their kept results
+void Test22() {
+    BabyTask::TaskGraph task_graph(2);
+    int x{ 1 }, y{ 10 };
+    std::atomic<int> runs{};
+
+    auto a = task_graph.makeTaskNode([&x, &runs]() { ++runs; return x; }, "a");
+    auto b = task_graph.makeTaskNode([&runs](int value) { ++runs; return value * 2; }, "b");
+    auto c = task_graph.makeTaskNode([&runs](int value) { ++runs; return value + 1; }, "c");
+    auto d = task_graph.makeTaskNode([&y, &runs]() { ++runs; return y; }, "d");
+    auto e = task_graph.makeTaskNode([&runs](int left, int right) { ++runs; return left + right; }, "e");
+    task_graph.connect<0>(*a, *b);
+    task_graph.connect<0>(*b, *c);
+    task_graph.connect<0>(*c, *e);
+    task_graph.connect<1>(*d, *e);
+
+    // first incremental execution runs everything
+    assert(task_graph.isDirty(*a));
+    assert(task_graph.executeIncremental() == 5);
+    assert((runs == 5) && (e->getValue() == 13) && !task_graph.isDirty(*a));
+
+    // nothing changed
+    assert(task_graph.executeIncremental() == 0);
+
+    // one input changed (d does not run, e gets its kept result)
+    x = 2;
+    task_graph.markDirty(*a);
+    assert(task_graph.executeIncremental() == 4);
+    assert((runs == 9) && (e->getValue() == 15));
+
+    // the other input changed (c delivers its kept result)
+    y = 20;
+    task_graph.markDirty(*d);
+    assert(task_graph.executeIncremental() == 2);
+    assert((runs == 11) && (e->getValue() == 25) && (b->getValue() == 4));
+
+    // a full execution still runs everything
+    task_graph.execute();
+    assert((runs == 16) && (e->getValue() == 25));
+
+    // a result which can not be kept (moved to its single consumer) makes its producer run again
+    BabyTask::TaskGraph move_graph(2);
+    std::atomic<int> produced{};
+    auto producer = move_graph.makeTaskNode([&produced]() { ++produced; return std::make_unique<int>(7); });
+    auto consumer = move_graph.makeTaskNode([](std::unique_ptr<int> value) { return *value; });
+    auto viewer = move_graph.makeTaskNode([]() { return std::vector<int>(1000, 1); });
+    auto reader = move_graph.makeTaskNode([](BabyTask::SharedView<std::vector<int>> values) { return values->size(); });
+    move_graph.connect<0>(*producer, *consumer);
+    move_graph.connect<0>(*viewer, *reader);
+    assert(move_graph.executeIncremental() == 4);
+    move_graph.markDirty(*consumer);
+    move_graph.markDirty(*reader);
+    assert(move_graph.executeIncremental() == 3);
+    assert((produced == 2) && (consumer->getValue() == 7) && (reader->getValue() == 1000));
+
+    // a chain marked dirty in its middle
+    BabyTask::TaskGraph chain_graph(2);
+    std::vector<BabyTask::BaseTaskNode*> chain;
+    for (int i{}; i < 1000; ++i) {
+        auto node = chain_graph.makeTaskNode([]() {});
+        if (!chain.empty()) node->setParent(*chain.back());
+        chain.push_back(node);
+    }
+    assert(chain_graph.executeIncremental() == 1000);
+    chain_graph.markDirty(*chain[900]);
+    chain_graph.markDirty(*chain[950]);
+    assert(chain_graph.executeIncremental() == 100);
+
+    // structure changes run everything again
+    auto extra = chain_graph.makeTaskNode([]() {});
+    extra->setParent(*chain.back());
+    assert(chain_graph.executeIncremental() == 1001);
+}
+
+// memoization:
+// repeated arguments do not run a memoized task again, results are shared only by nodes memoized in the same domain (across graphs too),
+// least recently used results are evicted to stay within the memory cap, and many nodes share a cache concurrently
+int Thrice(int x) { return 3 * x; }
+
+void Test23() {
+    BabyTask::MemoCache cache(1 << 20, 4);
+    assert(cache.shardCount() == 4);
+    std::atomic<int> runs{};
+    int input{ 3 };
+    auto hash_int = [](const std::tuple<int>& arguments) { return static_cast<std::uint64_t>(std::get<0>(arguments)); };
+    auto square = [&runs](int value) { ++runs; return std::vector<int>(100, value * value); };
+
+    // repeated arguments across executions do not run the task again
+    BabyTask::TaskGraph task_graph(2);
+    auto source = task_graph.makeTaskNode([&input]() { return input; });
+    auto squared = task_graph.makeTaskNode(square);
+    auto sum = task_graph.makeTaskNode([](BabyTask::SharedView<std::vector<int>> values) { return std::accumulate(values->begin(), values->end(), 0); });
+    auto first = task_graph.makeTaskNode([](BabyTask::SharedView<std::vector<int>> values) { return values->front(); });
+    task_graph.connect<0>(*source, *squared);
+    task_graph.connect<0>(*squared, *sum);
+    task_graph.connect<0>(*squared, *first);
+    const BabyTask::MemoDomain squares{ BabyTask::makeMemoDomain() };
+    squared->memoize(cache, squares, hash_int, [](const std::vector<int>& values) { return values.size() * sizeof(int); });
+    assert(squared->isMemoized());
+
+    task_graph.execute();
+    task_graph.execute();
+    assert((runs == 1) && (sum->getValue() == 900) && (first->getValue() == 9));
+    input = 4;
+    task_graph.execute();
+    input = 3;
+    task_graph.execute();
+    assert((runs == 2) && (sum->getValue() == 900));
+
+    BabyTask::MemoStatistics statistics{ cache.statistics() };
+    assert((statistics.mHits == 2) && (statistics.mMisses == 2) && (statistics.mInsertions == 2) && (statistics.mEntries == 2));
+    assert((statistics.mBytes > 800) && (statistics.mBytes < cache.capacity()));
+
+    // nodes memoized in the same domain share results (across graphs too), 'by value' consumers get a copy
+    BabyTask::TaskGraph other_graph(2);
+    auto other_source = other_graph.makeTaskNode([]() { return 4; });
+    auto other_squared = other_graph.makeTaskNode(square);
+    auto other_size = other_graph.makeTaskNode([](std::vector<int> values) { values.push_back(0); return values.size(); });
+    other_graph.connect<0>(*other_source, *other_squared);
+    other_graph.connect<0>(*other_squared, *other_size);
+    other_squared->memoize(cache, squares, hash_int);
+    other_graph.execute();
+    assert((runs == 2) && (other_size->getValue() == 101));
+
+    // a node memoized in a domain of its own does not see those results (even with equal hashes)
+    std::atomic<int> cubes{};
+    auto cube = other_graph.makeTaskNode([&cubes](int value) { ++cubes; return value * value * value; });
+    other_graph.connect<0>(*other_source, *cube);
+    cube->memoize(cache, hash_int);
+    other_graph.execute();
+    other_graph.execute();
+    assert((cubes == 1) && (cube->getValue() == 64));
+
+    // neither does a node of the same type (two function pointers of one signature)
+    BabyTask::TaskGraph pointer_graph(2);
+    auto five = pointer_graph.makeTaskNode([]() { return 5; });
+    auto twice = pointer_graph.makeTaskNode(&Twice);
+    auto thrice = pointer_graph.makeTaskNode(&Thrice);
+    pointer_graph.connect<0>(*five, *twice);
+    pointer_graph.connect<0>(*five, *thrice);
+    twice->memoize(cache, hash_int);
+    thrice->memoize(cache, hash_int);
+    for (int i{}; i < 2; ++i) {
+        pointer_graph.execute();
+        assert((twice->getValue() == 10) && (thrice->getValue() == 15));
+    }
+
+    // a shared domain never hands a result of another type
+    auto identity = other_graph.makeTaskNode([](int value) { return value; });
+    other_graph.connect<0>(*other_source, *identity);
+    identity->memoize(cache, squares, hash_int);
+    other_graph.execute();
+    assert(identity->getValue() == 4);
+
+    // not memoized anymore
+    squared->forget();
+    task_graph.execute();
+    assert((runs == 3) && !squared->isMemoized());
+
+    // memory cap - least recently used results are evicted
+    BabyTask::MemoCache small(1024, 1);
+    BabyTask::TaskGraph small_graph(1);
+    int key{};
+    std::atomic<int> computed{};
+    auto small_source = small_graph.makeTaskNode([&key]() { return key; });
+    auto small_node = small_graph.makeTaskNode([&computed](int value) { ++computed; return value; });
+    small_graph.connect<0>(*small_source, *small_node);
+    small_node->memoize(small, hash_int);
+    for (key = 0; key < 100; ++key) {
+        small_graph.execute();
+    }
+    statistics = small.statistics();
+    assert((computed == 100) && (statistics.mEvictions > 0) && (statistics.mBytes <= 1024));
+    assert(statistics.mEntries + statistics.mEvictions == 100);
+    key = 99;
+    small_graph.execute();
+    key = 0;
+    small_graph.execute();
+    assert((computed == 101) && (small_node->getValue() == 0));
+
+    // many nodes sharing a cache concurrently
+    BabyTask::MemoCache shared(1 << 20);
+    BabyTask::TaskGraph wide_graph(4);
+    std::atomic<int> evaluated{};
+    auto wide_source = wide_graph.makeTaskNode([]() { return 0; });
+    const BabyTask::MemoDomain offsets{ BabyTask::makeMemoDomain() };
+    for (int i{}; i < 256; ++i) {
+        auto node = wide_graph.makeTaskNode([&evaluated, i](int offset) { ++evaluated; return (i % 16) + offset; });
+        wide_graph.connect<0>(*wide_source, *node);
+        node->memoize(shared, offsets, [i](const std::tuple<int>& arguments) { return static_cast<std::uint64_t>((i % 16) + std::get<0>(arguments)); });
+    }
+    for (int i{}; i < 10; ++i) {
+        wide_graph.execute();
+    }
+    statistics = shared.statistics();
+    assert((statistics.mHits + statistics.mMisses == 2560) && (statistics.mEntries == 16));
+    assert(evaluated == static_cast<int>(statistics.mMisses));
+}
+
+// cancellation and deadlines:
+// a cancellation token or a deadline stops an execution - nodes which have not started are skipped and running nodes poll for it,
+// parallel nodes stop claiming chunks, nested graphs share the token, and a stopped incremental execution keeps its nodes dirty
+void Test24() {
+    using namespace std::chrono_literals;
+
+    // an execution which is not stopped
+    BabyTask::TaskGraph task_graph(2);
+    std::atomic<int> runs{};
+    auto make = [&task_graph, &runs]() { return task_graph.makeTaskNode([&runs]() { ++runs; }); };
+    std::vector<decltype(make())> chain;
+    for (int i{}; i < 100; ++i) {
+        auto node = make();
+        if (!chain.empty()) node->setParent(*chain.back());
+        chain.push_back(node);
+    }
+    BabyTask::CancellationToken token;
+    assert((task_graph.execute(token) == BabyTask::ExecutionStatus::Completed) && (runs == 100));
+    assert(task_graph.execute() == BabyTask::ExecutionStatus::Completed);
+
+    // a cancelled token skips every node
+    token.cancel();
+    assert(token.isCancelled());
+    assert((task_graph.execute(token) == BabyTask::ExecutionStatus::Cancelled) && (runs == 200));
+    assert(task_graph.status() == BabyTask::ExecutionStatus::Cancelled);
+    assert(!task_graph.isRunning());
+
+    // cancelled by a running node, nodes which have not started are skipped
+    BabyTask::CancellationToken midway;
+    auto cancel = task_graph.makeTaskNode([&midway]() { midway.cancel(); });
+    cancel->setParent(*chain[49]);
+    chain[50]->setParent(*cancel);
+    runs = 0;
+    assert((task_graph.execute(midway) == BabyTask::ExecutionStatus::Cancelled) && (runs == 50));
+
+    // the next execution starts anew
+    runs = 0;
+    assert((task_graph.execute() == BabyTask::ExecutionStatus::Completed) && (runs == 100));
+
+    // a deadline stops an execution, running nodes poll for it
+    BabyTask::TaskGraph slow_graph(2);
+    std::atomic<int> started{}, polled{};
+    std::vector<BabyTask::BaseTaskNode*> slow;
+    for (int i{}; i < 1000; ++i) {
+        auto node = slow_graph.makeTaskNode([&started, &polled]() {
+            ++started;
+            const auto end = std::chrono::steady_clock::now() + 1ms;
+            while (std::chrono::steady_clock::now() < end) {
+                if (BabyTask::TaskGraph::stopRequested()) {
+                    ++polled;
+                    return;
+                }
+            }
+        });
+        if (!slow.empty()) node->setParent(*slow.back());
+        slow.push_back(node);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    assert(slow_graph.executeFor(20ms) == BabyTask::ExecutionStatus::DeadlineExceeded);
+    assert(std::chrono::steady_clock::now() - start < 500ms);
+    assert((started < 1000) && (polled <= 1));
+    assert(!BabyTask::TaskGraph::stopRequested());
+
+    // a deadline which has already passed runs nothing
+    started = 0;
+    assert(slow_graph.execute(BabyTask::CancellationToken{}, std::chrono::steady_clock::now()) == BabyTask::ExecutionStatus::DeadlineExceeded);
+    assert(started == 0);
+
+    // asynchronous execution cancelled from another thread
+    BabyTask::CancellationToken remote;
+    started = 0;
+    auto handle = slow_graph.executeAsync(remote);
+    std::thread canceller([&remote]() { std::this_thread::sleep_for(5ms); remote.cancel(); });
+    assert(handle.wait() == BabyTask::ExecutionStatus::Cancelled);
+    canceller.join();
+    assert(started < 1000);
+
+    // parallel nodes stop claiming chunks, nested graphs share the token
+    BabyTask::TaskGraph outer(2);
+    BabyTask::TaskGraph inner(2);
+    BabyTask::CancellationToken nested;
+    std::atomic<int> visited{}, inner_runs{};
+    auto stopper = inner.makeTaskNode([&nested]() { nested.cancel(); });
+    auto after = inner.makeTaskNode([&inner_runs]() { ++inner_runs; });
+    after->setParent(*stopper);
+    auto graph_node = outer.makeGraphNode(inner);
+    auto range = outer.makeParallelForNode(0, 1'000'000, 1, [&visited](int) { ++visited; });
+    range->setParent(*graph_node);
+    assert(outer.execute(nested) == BabyTask::ExecutionStatus::Cancelled);
+    assert((inner_runs == 0) && (visited == 0) && (inner.status() == BabyTask::ExecutionStatus::Cancelled));
+
+    // a stopped incremental execution keeps its nodes dirty
+    BabyTask::TaskGraph incremental(2);
+    BabyTask::CancellationToken cancelled;
+    cancelled.cancel();
+    std::atomic<int> computed{};
+    auto first = incremental.makeTaskNode([&computed]() { ++computed; return 1; });
+    auto second = incremental.makeTaskNode([&computed](int value) { ++computed; return value + 1; });
+    incremental.connect<0>(*first, *second);
+    incremental.executeIncremental(cancelled);
+    assert((computed == 0) && incremental.isDirty(*first) && incremental.isDirty(*second));
+    assert((incremental.executeIncremental() == 2) && (computed == 2));
+    incremental.markDirty(*second);
+    incremental.executeIncremental(cancelled);
+    assert((computed == 2) && incremental.isDirty(*second) && !incremental.isDirty(*first));
+    assert((incremental.executeIncremental() == 1) && (computed == 3) && (second->getValue() == 2));
+}
+
+// exceptions:
+// a throwing task fails its execution fast and the first exception is rethrown (by execute, by the handle of an asynchronous execution,
+// from parallel node bodies and nested graphs), and the graph can be executed again
+void Test25() {
+    // a throwing task fails the execution, nodes which have not started are skipped and the exception is rethrown
+    BabyTask::TaskGraph task_graph(2);
+    std::atomic<int> runs{};
+    bool fail{ true };
+    auto source = task_graph.makeTaskNode([&runs]() { ++runs; return 1; });
+    auto thrower = task_graph.makeTaskNode([&runs, &fail](int value) {
+        ++runs;
+        if (fail) throw std::runtime_error("bad input");
+        return value + 1;
+    });
+    auto sink = task_graph.makeTaskNode([&runs](int value) { ++runs; return value * 2; });
+    task_graph.connect<0>(*source, *thrower);
+    task_graph.connect<0>(*thrower, *sink);
+    std::vector<BabyTask::BaseTaskNode*> tail;
+    for (int i{}; i < 100; ++i) {
+        auto node = task_graph.makeTaskNode([&runs]() { ++runs; });
+        node->setParent(*sink);
+        tail.push_back(node);
+    }
+
+    bool caught{};
+    try {
+        task_graph.execute();
+    }
+    catch (const std::runtime_error& error) {
+        caught = (std::string(error.what()) == "bad input");
+    }
+    assert(caught && (runs == 2) && (task_graph.status() == BabyTask::ExecutionStatus::Failed) && !task_graph.isRunning());
+
+    // the graph (and its pool) can be executed again
+    fail = false;
+    runs = 0;
+    assert((task_graph.execute() == BabyTask::ExecutionStatus::Completed) && (runs == 103) && (sink->getValue() == 4));
+
+    // asynchronous execution rethrows from the handle
+    fail = true;
+    caught = false;
+    auto handle = task_graph.executeAsync();
+    try {
+        handle.wait();
+    }
+    catch (const std::runtime_error&) {
+        caught = true;
+    }
+    assert(caught);
+
+    // only the first of several exceptions is kept
+    BabyTask::TaskGraph wide_graph(4);
+    for (int i{}; i < 64; ++i) {
+        wide_graph.makeTaskNode([i]() { throw i; });
+    }
+    caught = false;
+    try {
+        wide_graph.execute();
+    }
+    catch (int) {
+        caught = true;
+    }
+    assert(caught);
+
+    // parallel node bodies and nested graphs
+    BabyTask::TaskGraph outer(2);
+    BabyTask::TaskGraph inner(2);
+    std::atomic<int> visited{}, after{};
+    auto range = outer.makeParallelForNode(0, 100'000, 1, [&visited](int i) {
+        ++visited;
+        if (i == 10) throw std::out_of_range("range");
+    });
+    auto next = outer.makeTaskNode([&after]() { ++after; });
+    next->setParent(*range);
+    caught = false;
+    try {
+        outer.execute();
+    }
+    catch (const std::out_of_range&) {
+        caught = true;
+    }
+    assert(caught && (after == 0) && (visited < 100'000));
+
+    inner.makeTaskNode([]() { throw std::length_error("nested"); });
+    auto nested = outer.makeGraphNode(inner);
+    next->setParent(*nested);
+    caught = false;
+    try {
+        outer.execute();
+    }
+    catch (const std::exception&) {
+        caught = true;
+    }
+    assert(caught && (after == 0));
+
+    auto subflow = outer.makeSubflowNode([](BabyTask::Subflow& flow) { flow.makeTaskNode([]() { throw std::bad_alloc(); }); });
+    next->setParent(*subflow);
+    caught = false;
+    try {
+        outer.execute();
+    }
+    catch (const std::exception&) {
+        caught = true;
+    }
+    assert(caught && (after == 0));
+
+    // an incremental execution which has thrown keeps its nodes dirty
+    BabyTask::TaskGraph incremental(2);
+    bool throwing{ true };
+    auto flaky = incremental.makeTaskNode([&throwing]() { if (throwing) throw 1; return 1; });
+    caught = false;
+    try {
+        incremental.executeIncremental();
+    }
+    catch (int) {
+        caught = true;
+    }
+    throwing = false;
+    assert(caught && incremental.isDirty(*flaky));
+    assert((incremental.executeIncremental() == 1) && (flaky->getValue() == 1));
+}
+
+// cycle detection and topological order:
+// cycles are found without recursion (in a deep chain too) and named by compile, topological order and levels,
+// and edges which close a cycle are rejected as they are declared once cycle checking is enabled
+void Test26() {
+    // a deep chain (a recursive search would overflow the stack)
+    BabyTask::TaskGraph chain_graph(1);
+    auto make = [&chain_graph](const char* name = "") { return chain_graph.makeTaskNode([]() {}, name); };
+    std::vector<decltype(make())> chain;
+    for (int i{}; i < 500'000; ++i) {
+        auto node = make();
+        if (!chain.empty()) node->setParent(*chain.back());
+        chain.push_back(node);
+    }
+    assert(!chain_graph.hasCycle() && chain_graph.findCycle().empty());
+
+    // the cycle is found and reported
+    chain.front()->setParent(*chain[1000]);
+    assert(chain_graph.hasCycle());
+    const std::vector<BabyTask::BaseTaskNode*> cycle{ chain_graph.findCycle() };
+    assert(cycle.size() == 1001);
+    for (std::size_t i{}; i < cycle.size(); ++i) {
+        assert(cycle[i] == chain[i]);
+    }
+
+    BabyTask::TaskGraph task_graph(2);
+    auto a = task_graph.makeTaskNode([]() { return 1; }, "a");
+    auto b = task_graph.makeTaskNode([](int value) { return value + 1; }, "b");
+    auto c = task_graph.makeTaskNode([](int value) { return value * 2; }, "c");
+    auto d = task_graph.makeTaskNode([]() {}, "d");
+    task_graph.connect<0>(*a, *b);
+    task_graph.connect<0>(*b, *c);
+    d->setParent(*c);
+    d->setParent(*a);
+
+    // topological order and levels
+    const std::vector<BabyTask::BaseTaskNode*> order{ task_graph.topologicalOrder() };
+    assert((order.size() == 4) && (order[0] == a) && (order[1] == b) && (order[2] == c) && (order[3] == d));
+    const std::vector<std::vector<BabyTask::BaseTaskNode*>> levels{ task_graph.levels() };
+    assert((levels.size() == 4) && (levels[0].size() == 1) && (levels[3][0] == d));
+
+    // a graph with a cycle can not be compiled, its cycle is named
+    auto e = task_graph.makeTaskNode([]() {}, "e");
+    auto f = task_graph.makeTaskNode([]() {}, "f");
+    e->setParent(*f);
+    f->setParent(*e);
+    std::string message;
+    try {
+        task_graph.topologicalOrder();
+    }
+    catch (const std::logic_error& error) {
+        message = error.what();
+    }
+    assert(message == "task graph has a cycle: 'e' -> 'f' -> 'e'.");
+
+    // cycle checking can not be enabled on a graph with a cycle
+    bool thrown{};
+    try {
+        task_graph.setCycleChecking(true);
+    }
+    catch (const std::logic_error&) {
+        thrown = true;
+    }
+    assert(thrown && !task_graph.getCycleChecking());
+
+    // edges which close a cycle are rejected as they are declared (and the graph is left unchanged)
+    BabyTask::TaskGraph checked(2);
+    checked.setCycleChecking(true);
+    std::atomic<int> runs{};
+    auto node = [&checked, &runs](const char* name) { return checked.makeTaskNode([&runs]() { ++runs; }, name); };
+    std::vector<decltype(node(""))> nodes;
+    for (const char* name : { "n0", "n1", "n2", "n3", "n4", "n5" }) {
+        nodes.push_back(node(name));
+    }
+
+    // declared against the order nodes were made in (so the kept order is repaired)
+    nodes[0]->setParent(*nodes[5]);
+    nodes[1]->setParent(*nodes[0]);
+    nodes[2]->setParent(*nodes[4]);
+    nodes[4]->setParent(*nodes[1]);
+    auto rejected = [](auto&& xi_declare) {
+        try {
+            xi_declare();
+        }
+        catch (const std::logic_error&) {
+            return true;
+        }
+        return false;
+    };
+    assert(rejected([&]() { nodes[5]->setParent(*nodes[2]); }));
+    assert(rejected([&]() { nodes[3]->setParent(*nodes[3]); }));
+    assert(!rejected([&]() { nodes[3]->setParent(*nodes[2]); }));
+    assert(rejected([&]() { nodes[5]->setParent(*nodes[3]); }));
+    assert(!checked.hasCycle());
+    checked.execute();
+    assert(runs == 6);
+
+    const std::vector<BabyTask::BaseTaskNode*> checked_order{ checked.topologicalOrder() };
+    std::vector<std::size_t> position(6);
+    for (std::size_t i{}; i < checked_order.size(); ++i) {
+        position[static_cast<std::size_t>(checked_order[i]->getName()[1] - '0')] = i;
+    }
+    assert((position[5] < position[0]) && (position[0] < position[1]) && (position[1] < position[4]) && (position[4] < position[2]) && (position[2] < position[3]));
+
+    // data flow edges are checked as well
+    auto source = checked.makeTaskNode([]() { return 1; }, "source");
+    auto sink = checked.makeTaskNode([](int value) { return value; }, "sink");
+    auto back = checked.makeTaskNode([](int value) { return value; }, "back");
+    checked.connect<0>(*source, *sink);
+    source->setParent(*nodes[0]);
+    assert(rejected([&]() { checked.connect<0>(*sink, *back); nodes[0]->setParent(*back); }));
+    assert(!checked.hasCycle());
+}
+
 int main() {
 
 	Test1();
     Test2();
     Test3();
+    Test4();
+    Test5();
+    Test6();
+    Test7();
+    Test8();
+    Test9();
+    Test10();
+    Test11();
+    Test12();
+    Test13();
+    Test14();
+    Test15();
+    Test16();
+    Test17();
+    Test18();
+    Test19();
+    Test20();
+    Test21();
+    Test22();
+    Test23();
+    Test24();
+    Test25();
+    Test26();
 
 	return 1;
 }
\ No newline at end of file
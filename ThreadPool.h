@@ -26,33 +26,398 @@
 #pragma once
 
 #include "Queue.h"
+#include "BoundedQueue.h"
+#include "WorkStealingDeque.h"
+#include "Task.h"
+#include "Topology.h"
+#include "EventCount.h"
 #include <atomic>
+#include <deque>
 #include <exception>
 #include <functional>
 #include <future>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <thread>
 #include <vector>
 
 namespace BabyTask {
 
+    /**
+    * \brief thread pool scheduling policy
+    **/
+    enum class SchedulingPolicy {
+        SharedQueue,    // all threads pop tasks from one shared queue
+        WorkStealing    // each thread owns a deque (LIFO), idle threads steal from the other deques (FIFO)
+    };
+
+    /**
+    * \brief thread pool idle loop counters (used to tune the spin budget)
+    **/
+    struct IdleStatistics {
+        std::uint64_t mSpinHits{};              // tasks found while spinning
+        std::uint64_t mYieldHits{};             // tasks found while yielding
+        std::uint64_t mParks{};                 // times a worker went to sleep
+        std::uint64_t mNotifications{};         // pushes which woke a sleeping worker
+        std::uint64_t mSkippedNotifications{};  // pushes which found no sleeping worker (no notification)
+    };
+
     /**
     * \brief thread pool
+    *
+    * @param {QueueType} task queue (Queue - mutex protected and unbounded, BoundedQueue - lock free and bounded)
     **/
-    class ThreadPool {
+    template<template<typename> class QueueType> class BasicThreadPool {
 
         // aliases
-        using taskSignature = std::function<void(std::size_t id)>;  // void task(thread running the task)
+        using taskSignature = Task;                         // void task(thread running the task)
+        using Deque         = WorkStealingDeque<TaskSlot*>;
+
+        // work stealing deques visible to thieves (a new list is published whenever a deque is added)
+        struct DequeList {
+            std::vector<Deque*> mDeques;
+            std::vector<std::size_t> mNodes;    // NUMA node of each deque worker
+        };
+
+        // idle loop counters (of a worker, or of all non pool threads)
+        struct alignas(64) IdleCounters {
+            std::atomic<std::uint64_t> mSpinHits{};
+            std::atomic<std::uint64_t> mYieldHits{};
+            std::atomic<std::uint64_t> mParks{};
+            std::atomic<std::uint64_t> mNotifications{};
+            std::atomic<std::uint64_t> mSkippedNotifications{};
+        };
+
+        // identity of the pool worker running on the current thread
+        struct WorkerContext {
+            const BasicThreadPool* mPool{}; // pool which owns the worker (null if current thread is not a pool worker)
+            Deque* mDeque{};                // worker deque (null in shared queue policy)
+            TaskCache* mCache{};            // worker task slots
+            IdleCounters* mCounters{};      // worker idle loop counters
+            std::size_t mId{};              // worker index
+            std::size_t mNode{};            // worker NUMA node
+            std::size_t mVictim{};          // index of the next deque to steal from
+            std::size_t mTick{};            // amount of tasks popped by worker
+        };
 
         // properties
         std::vector<std::unique_ptr<std::thread>> mThreads;     // thread 'pool'
         std::vector<std::shared_ptr<std::atomic<bool>>> mFlags; // a flag per thread, if its true then thread is finished
-        Queue<taskSignature*> mQueue;                           // task queue
+        QueueType<TaskSlot*> mQueue;                            // task queue (in work stealing policy - tasks pushed by non pool threads)
+        std::vector<std::unique_ptr<QueueType<TaskSlot*>>> mNodeQueues; // per NUMA node queue of tasks hinted to that node (pinned pools only)
+        CpuTopology mTopology;                                  // NUMA topology workers are placed on
+        Placement mPlacement;                                   // worker placement request
+        std::vector<WorkerPlacement> mPlacements;               // placement of each worker
+        std::vector<std::unique_ptr<Deque>> mDeques;            // work stealing deques (never released before pool destruction)
+        std::vector<std::unique_ptr<TaskCache>> mCaches;        // per worker task slots (never released before pool destruction)
+        TaskCache mExternalCache;                               // task slots of tasks pushed by non pool threads
+        std::mutex mExternalMutex;                              // guards mExternalCache
+        std::deque<TaskSlot*> mOverflow;                        // tasks pushed by pool workers while the (bounded) queue was full
+        std::mutex mOverflowMutex;                              // guards mOverflow
+        std::atomic<std::size_t> mOverflowCount{};              // amount of tasks in mOverflow
+        std::vector<std::unique_ptr<DequeList>> mDequeLists;    // all deque lists ever published
+        std::atomic<DequeList*> mDequeList;                     // current deque list
+        SchedulingPolicy mPolicy;                               // scheduling policy
         std::atomic<bool> mDone;                                // thread done?
         std::atomic<bool> mStop;                                // thread stopped>
         std::atomic<std::size_t> mIdleCount;                    // amount of idle threads
-        std::mutex mMutex;
-        std::condition_variable mControlVariable;
+        std::atomic<std::size_t> mFairnessInterval;             // every so many pops, a worker takes the oldest task first
+        std::atomic<std::size_t> mSpinCount;                    // amount of busy wait attempts of an idle worker before yielding
+        std::atomic<std::size_t> mYieldCount;                   // amount of yielding attempts of an idle worker before sleeping
+        std::vector<std::unique_ptr<IdleCounters>> mCounters;   // per worker idle loop counters (never released before pool destruction)
+        IdleCounters mExternalCounters;                         // idle loop counters of non pool threads
+        EventCount mEvent;                                      // idle workers sleep on it
+
+        // increment a counter (relaxed, owner thread only)
+        static void count(std::atomic<std::uint64_t>& xo_counter) {
+            xo_counter.store(xo_counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        // return current thread worker context
+        static WorkerContext& currentWorker() {
+            static thread_local WorkerContext context;
+            return context;
+        }
+
+        /**
+        * \brief place a task in a recycled slot, taken from the worker cache
+        *        (or from the shared cache when called by a non pool thread)
+        *
+        * @param {F,        in}  task
+        * @param {TaskSlot, out} slot holding the task
+        **/
+        template<typename F>
+        TaskSlot* makeTask(F&& xi_task) {
+            const WorkerContext& worker = currentWorker();
+            if ((worker.mPool == this) && worker.mCache) {
+                return worker.mCache->allocate(std::forward<F>(xi_task));
+            }
+
+            std::unique_lock<std::mutex> lock(mExternalMutex);
+            return mExternalCache.allocate(std::forward<F>(xi_task));
+        }
+
+        /**
+        * \brief run a task and recycle its slot (even if an exception occurred)
+        *
+        * @param {TaskSlot, in} slot holding the task
+        * @param {size_t,   in} index of thread running the task
+        **/
+        static void runTask(TaskSlot* xi_slot, std::size_t xi_id) {
+            struct Recycle {
+                TaskSlot* mSlot;
+                ~Recycle() { TaskCache::release(mSlot, currentWorker().mCache); }
+            } recycle{ xi_slot };
+
+            xi_slot->mTask(xi_id);
+        }
+
+        /**
+        * \brief pop a task for a worker: own deque (LIFO), own NUMA node queue, shared queue, steal from deques of
+        *        workers on the same node (FIFO), tasks hinted to other nodes and then steal from any other deque.
+        *        every 'mFairnessInterval' pops the queues and the oldest task of its own deque are tried first,
+        *        so tasks of other graphs (or tasks buried under a stream of local descendants) are never starved.
+        *
+        * @param {WorkerContext, in}  worker context
+        * @param {TaskSlot,      out} task
+        * @param {bool,          out} true if a task was found
+        **/
+        bool popTask(WorkerContext& xi_worker, TaskSlot*& xo_task) {
+            const std::size_t interval{ mFairnessInterval.load(std::memory_order_relaxed) };
+            if ((interval > 0) && (++xi_worker.mTick % interval == 0)) {
+                if (mQueue.pop(xo_task) || popOverflow(xo_task) || popNode(xi_worker.mNode, xo_task) || (xi_worker.mDeque && xi_worker.mDeque->steal(xo_task))) {
+                    return true;
+                }
+            }
+
+            if (xi_worker.mDeque && xi_worker.mDeque->pop(xo_task)) {
+                return true;
+            }
+
+            if (popNode(xi_worker.mNode, xo_task) || mQueue.pop(xo_task) || popOverflow(xo_task)) {
+                return true;
+            }
+
+            if (steal(xi_worker, true, xo_task)) {
+                return true;
+            }
+
+            // a locality hint is a preference, an idle worker on another node still runs the task
+            if (mNodeQueues.size() < 2) {
+                return false;
+            }
+
+            for (std::size_t i{ 1 }; i < mNodeQueues.size(); ++i) {
+                if (popNode((xi_worker.mNode + i) % mNodeQueues.size(), xo_task)) {
+                    return true;
+                }
+            }
+
+            return steal(xi_worker, false, xo_task);
+        }
+
+        /**
+        * \brief pop a task hinted to a given NUMA node
+        *
+        * @param {size_t,   in}  node
+        * @param {TaskSlot, out} task
+        * @param {bool,     out} true if a task was found
+        **/
+        bool popNode(std::size_t xi_node, TaskSlot*& xo_task) {
+            return (xi_node < mNodeQueues.size()) && mNodeQueues[xi_node]->pop(xo_task);
+        }
+
+        /**
+        * \brief steal a task from the deque of another worker (work stealing policy only)
+        *
+        * @param {WorkerContext, in}  worker context
+        * @param {bool,          in}  true to steal from workers on the same NUMA node, false to steal from workers on other nodes
+        * @param {TaskSlot,      out} task
+        * @param {bool,          out} true if a task was found
+        **/
+        bool steal(WorkerContext& xi_worker, bool xi_sameNode, TaskSlot*& xo_task) {
+            if (mPolicy != SchedulingPolicy::WorkStealing) {
+                return false;
+            }
+
+            const DequeList* list{ mDequeList.load(std::memory_order_acquire) };
+            const std::size_t len{ list ? list->mDeques.size() : 0 };
+            for (std::size_t i{}; i < len; ++i) {
+                const std::size_t index{ (xi_worker.mVictim + i) % len };
+                if ((list->mNodes[index] == xi_worker.mNode) != xi_sameNode) continue;
+
+                Deque* victim{ list->mDeques[index] };
+                if ((victim != xi_worker.mDeque) && victim->steal(xo_task)) {
+                    xi_worker.mVictim = index;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+        * \brief enqueue a task, a pool worker (in work stealing policy) pushes it to its own deque.
+        *        a task hinted to a NUMA node goes to that node queue, unless it was pushed by a worker on that node.
+        *
+        * @param {TaskSlot, in} task
+        * @param {size_t,   in} NUMA node hint (AnyNode, or ignored, if pool workers are not pinned)
+        **/
+        void enqueue(TaskSlot* xi_task, std::size_t xi_node = AnyNode) {
+            const WorkerContext& worker = currentWorker();
+            const bool hinted{ xi_node < mNodeQueues.size() };
+            if ((worker.mPool == this) && worker.mDeque && (!hinted || (worker.mNode == xi_node))) {
+                worker.mDeque->push(xi_task);
+            }
+            else {
+                QueueType<TaskSlot*>& queue{ hinted ? *mNodeQueues[xi_node] : mQueue };
+                if (!queue.push(xi_task)) {
+                    // bounded queue is full: a pool worker spills the task (waiting might deadlock the pool),
+                    // any other thread waits for the workers to make room
+                    if (worker.mPool == this) {
+                        spill(worker, xi_task);
+                    }
+                    else {
+                        while (!queue.push(xi_task)) {
+                            if ((size() == 0) || mStop || mDone) {
+                                TaskCache::release(xi_task, nullptr);
+                                throw std::logic_error("thread pool queue is full and the pool has no running workers.");
+                            }
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            }
+
+            notify(worker);
+        }
+
+        /**
+        * \brief keep a task pushed by a pool worker while the queue is full, in the worker deque (work stealing policy) or in the overflow list
+        *
+        * @param {WorkerContext, in} context of pushing worker
+        * @param {TaskSlot,      in} task
+        **/
+        void spill(const WorkerContext& xi_worker, TaskSlot* xi_task) {
+            if (xi_worker.mDeque) {
+                xi_worker.mDeque->push(xi_task);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(mOverflowMutex);
+            mOverflow.push_back(xi_task);
+            mOverflowCount.fetch_add(1, std::memory_order_release);
+        }
+
+        /**
+        * \brief pop the oldest task of the overflow list
+        *
+        * @param {TaskSlot, out} task
+        * @param {bool,     out} true if a task was found
+        **/
+        bool popOverflow(TaskSlot*& xo_task) {
+            if (mOverflowCount.load(std::memory_order_acquire) == 0) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> lock(mOverflowMutex);
+            if (mOverflow.empty()) {
+                return false;
+            }
+
+            xo_task = mOverflow.front();
+            mOverflow.pop_front();
+            mOverflowCount.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+        * \brief wake a sleeping worker (if there is one) after a task was pushed
+        *
+        * @param {WorkerContext, in} context of pushing thread
+        **/
+        void notify(const WorkerContext& xi_worker) {
+            const bool woke{ mEvent.notify() };
+            if ((xi_worker.mPool == this) && xi_worker.mCounters) {
+                count(woke ? xi_worker.mCounters->mNotifications : xi_worker.mCounters->mSkippedNotifications);
+            }
+            else {
+                (woke ? mExternalCounters.mNotifications : mExternalCounters.mSkippedNotifications).fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+        * \brief wait for a task: spin (busy wait), then yield and then sleep until a task is pushed
+        *
+        * @param {WorkerContext, in}  worker context
+        * @param {atomic<bool>,  in}  worker stop flag
+        * @param {TaskSlot,      out} task
+        * @param {bool,          out} true if a task was found, false if worker should exit
+        **/
+        bool waitTask(WorkerContext& xi_worker, const std::atomic<bool>& xi_flag, TaskSlot*& xo_task) {
+            const std::size_t spins{ mSpinCount.load(std::memory_order_relaxed) };
+            for (std::size_t i{}; (i < spins) && !mDone && !xi_flag; ++i) {
+                cpuRelax();
+                if (popTask(xi_worker, xo_task)) {
+                    count(xi_worker.mCounters->mSpinHits);
+                    return true;
+                }
+            }
+
+            const std::size_t yields{ mYieldCount.load(std::memory_order_relaxed) };
+            for (std::size_t i{}; (i < yields) && !mDone && !xi_flag; ++i) {
+                std::this_thread::yield();
+                if (popTask(xi_worker, xo_task)) {
+                    count(xi_worker.mCounters->mYieldHits);
+                    return true;
+                }
+            }
+
+            while (true) {
+                const EventCount::Key key{ mEvent.prepareWait() };
+                if (popTask(xi_worker, xo_task)) {
+                    mEvent.cancelWait();
+                    return true;
+                }
+
+                if (mDone || xi_flag) {
+                    mEvent.cancelWait();
+                    return false;
+                }
+
+                ++mIdleCount;
+                count(xi_worker.mCounters->mParks);
+                mEvent.commitWait(key);
+                --mIdleCount;
+            }
+        }
+
+        /**
+        * \brief add a work stealing deque and publish the updated deque list
+        *
+        * @param {size_t, in}  NUMA node of deque worker
+        * @param {Deque,  out} new deque
+        **/
+        Deque* addDeque(std::size_t xi_node) {
+            const DequeList* previous{ mDequeList.load(std::memory_order_relaxed) };
+            mDeques.emplace_back(std::make_unique<Deque>());
+
+            auto list = std::make_unique<DequeList>();
+            list->mDeques.reserve(mDeques.size());
+            for (auto& deque : mDeques) {
+                list->mDeques.push_back(deque.get());
+            }
+            if (previous) {
+                list->mNodes = previous->mNodes;
+            }
+            list->mNodes.push_back(xi_node);
+
+            mDequeList.store(list.get(), std::memory_order_release);
+            mDequeLists.emplace_back(std::move(list));
+
+            return mDeques.back().get();
+        }
 
         /**
         * \brief set thread #i
@@ -61,32 +426,68 @@ namespace BabyTask {
         **/
         void set_thread(std::size_t i) {
             std::shared_ptr<std::atomic<bool>> flag(mFlags[i]);
+            const WorkerPlacement placement{ mTopology.place(mPlacement, i) };
+            if (mPlacements.size() <= i) {
+                mPlacements.resize(i + 1);
+            }
+            mPlacements[i] = placement;
+
+            Deque* deque{ (mPolicy == SchedulingPolicy::WorkStealing) ? addDeque(placement.mNode) : nullptr };
+            mCaches.emplace_back(std::make_unique<TaskCache>());
+            TaskCache* cache{ mCaches.back().get() };
+            mCounters.emplace_back(std::make_unique<IdleCounters>());
+            IdleCounters* counters{ mCounters.back().get() };
+
+            auto f = [this, i, flag, deque, cache, counters, placement]() {
+                if (placement.mPinned) {
+                    pinCurrentThread(placement.mCpu);
+                }
 
-            auto f = [this, i, flag]() {
                 std::atomic<bool>& flagPtr = *flag;
-                taskSignature* task;
-                bool isPop{ mQueue.pop(task) };
+                WorkerContext& worker = currentWorker();
+                worker.mPool = this;
+                worker.mDeque = deque;
+                worker.mCache = cache;
+                worker.mCounters = counters;
+                worker.mId = i;
+                worker.mNode = placement.mNode;
+                worker.mVictim = i;
+
+                // a stopped worker hands its remaining deque tasks back to the shared queue
+                auto retire = [this, deque, cache]() {
+                    TaskSlot* task;
+                    while (deque && deque->pop(task)) {
+                        while (!mQueue.push(task)) {
+                            // pool is stopped, no one will drain the queue
+                            if (mStop) {
+                                TaskCache::release(task, cache);
+                                break;
+                            }
+                            std::this_thread::yield();
+                        }
+                    }
+
+                    mEvent.notifyAll();
+                };
+
+                TaskSlot* task;
+                bool isPop{ popTask(worker, task) };
 
                 while (true) {
                     // while queue is not empty
                     while (isPop) {
-                        std::unique_ptr<taskSignature> func(task);  // delete the function (even if an exception occurred) at return
-                        (*task)(i);
+                        runTask(task, i);
 
                         // if the thread is required to stop, return even if the queue is not empty yet
-                        if (flagPtr) return;
-                        isPop = mQueue.pop(task);
+                        if (flagPtr) {
+                            retire();
+                            return;
+                        }
+                        isPop = popTask(worker, task);
                     }
 
                     // queue is empty here, wait for the next task
-                    std::unique_lock<std::mutex> lock(mMutex);
-                    ++mIdleCount;
-                    mControlVariable.wait(lock, [this, &task, &isPop, &flagPtr]() {
-                        isPop = mQueue.pop(task);
-                        return (isPop || mDone || flagPtr);
-                    });
-
-                    --mIdleCount;
+                    isPop = waitTask(worker, flagPtr, task);
 
                     // if queue is empty and done, return
                     if (!isPop) return;
@@ -100,23 +501,44 @@ namespace BabyTask {
         public:
 
             // default constructor
-            ThreadPool() : mIdleCount(0), mStop(false), mDone(false) {}
+            BasicThreadPool() : mDequeList(nullptr), mPolicy(SchedulingPolicy::SharedQueue), mDone(false), mStop(false), mIdleCount(0), mFairnessInterval(61), mSpinCount(64), mYieldCount(16) {}
 
-            // construct with a given number of threads
-            ThreadPool(std::size_t xi_count) : mIdleCount(0), mStop(false), mDone(false) {
+            // construct with a given number of threads and scheduling policy
+            BasicThreadPool(std::size_t xi_count, SchedulingPolicy xi_policy = SchedulingPolicy::SharedQueue) : mDequeList(nullptr), mPolicy(xi_policy),
+                                                                                                                 mDone(false), mStop(false), mIdleCount(0), mFairnessInterval(61), mSpinCount(64), mYieldCount(16) {
+                resize(xi_count);
+            }
+
+            /**
+            * \brief construct with a given number of threads pinned to cpus (the OS does not migrate them).
+            *        a pinned pool holds a task queue per NUMA node, for tasks submitted with a locality hint.
+            *
+            * @param {size_t,           in} number of threads
+            * @param {SchedulingPolicy, in} scheduling policy
+            * @param {Placement,        in} worker placement (compact, scatter or explicit cpu set)
+            * @param {CpuTopology,      in} NUMA topology (default is the topology of this machine)
+            **/
+            BasicThreadPool(std::size_t xi_count, SchedulingPolicy xi_policy, const Placement& xi_placement,
+                            const CpuTopology& xi_topology = CpuTopology::system()) : mTopology(xi_topology), mPlacement(xi_placement), mDequeList(nullptr),
+                                                                                      mPolicy(xi_policy), mDone(false), mStop(false), mIdleCount(0), mFairnessInterval(61), mSpinCount(64), mYieldCount(16) {
+                if (mPlacement.mPolicy != AffinityPolicy::None) {
+                    for (std::size_t i{}; i < mTopology.nodeCount(); ++i) {
+                        mNodeQueues.emplace_back(std::make_unique<QueueType<TaskSlot*>>());
+                    }
+                }
                 resize(xi_count);
             }
 
             // destructor
-            ~ThreadPool() { stop(true); }
+            ~BasicThreadPool() { stop(true); }
 
             // copy semantics
-            ThreadPool(const ThreadPool&) = delete;
-            ThreadPool& operator=(const ThreadPool&) = delete;
+            BasicThreadPool(const BasicThreadPool&) = delete;
+            BasicThreadPool& operator=(const BasicThreadPool&) = delete;
 
             // move semantics
-            ThreadPool(ThreadPool&&) noexcept = delete;
-            ThreadPool& operator=(ThreadPool&&) noexcept = delete;
+            BasicThreadPool(BasicThreadPool&&) noexcept = delete;
+            BasicThreadPool& operator=(BasicThreadPool&&) noexcept = delete;
 
             // return number of running threads
             std::size_t size() const { return mThreads.size(); }
@@ -127,6 +549,64 @@ namespace BabyTask {
             // return reference to thread #i
             std::thread& getThread(std::size_t i) { return *this->mThreads[i]; }
 
+            // return pool scheduling policy
+            SchedulingPolicy policy() const { return mPolicy; }
+
+            // return placement of thread #i
+            const WorkerPlacement& placement(std::size_t i) const { return mPlacements[i]; }
+
+            // return amount of NUMA nodes tasks can be hinted to (zero if workers are not pinned)
+            std::size_t nodeCount() const { return mNodeQueues.size(); }
+
+            // return NUMA node of the calling pool worker (AnyNode if called by a non pool thread)
+            std::size_t currentNode() const {
+                const WorkerContext& worker = currentWorker();
+                return (worker.mPool == this) ? worker.mNode : AnyNode;
+            }
+
+            /**
+            * \brief set how often (in popped tasks) a worker takes the oldest available task instead of the newest one
+            *
+            * @param {size_t, in} fairness interval (zero disables it)
+            **/
+            void setFairnessInterval(std::size_t xi_interval) { mFairnessInterval.store(xi_interval, std::memory_order_relaxed); }
+
+            /**
+            * \brief set how long an idle worker looks for tasks before it goes to sleep.
+            *        a longer budget lowers wake up latency of bursty work, at the cost of cpu time burned while idle.
+            *
+            * @param {size_t, in} amount of busy wait attempts
+            * @param {size_t, in} amount of yielding attempts (after busy waiting)
+            **/
+            void setSpinBudget(std::size_t xi_spins, std::size_t xi_yields) {
+                mSpinCount.store(xi_spins, std::memory_order_relaxed);
+                mYieldCount.store(xi_yields, std::memory_order_relaxed);
+            }
+
+            // return amount of busy wait attempts of an idle worker
+            std::size_t spinCount() const { return mSpinCount.load(std::memory_order_relaxed); }
+
+            // return amount of yielding attempts of an idle worker
+            std::size_t yieldCount() const { return mYieldCount.load(std::memory_order_relaxed); }
+
+            // return idle loop counters (summed over all workers)
+            IdleStatistics idleStatistics() const {
+                IdleStatistics statistics;
+                auto add = [&statistics](const IdleCounters& xi_counters) {
+                    statistics.mSpinHits += xi_counters.mSpinHits.load(std::memory_order_relaxed);
+                    statistics.mYieldHits += xi_counters.mYieldHits.load(std::memory_order_relaxed);
+                    statistics.mParks += xi_counters.mParks.load(std::memory_order_relaxed);
+                    statistics.mNotifications += xi_counters.mNotifications.load(std::memory_order_relaxed);
+                    statistics.mSkippedNotifications += xi_counters.mSkippedNotifications.load(std::memory_order_relaxed);
+                };
+
+                add(mExternalCounters);
+                for (const auto& counters : mCounters) {
+                    add(*counters);
+                }
+                return statistics;
+            }
+
             /**
             * \brief change number of threads in pool
             *
@@ -154,32 +634,44 @@ namespace BabyTask {
                     }
 
                     // stop waiting threads ( so they could be deleted safely
-                    {
-                        std::unique_lock<std::mutex> lock(mMutex);
-                        mControlVariable.notify_all();
-                    }
+                    mEvent.notifyAll();
 
                     mThreads.resize(xi_count);
                     mFlags.resize(xi_count);
                 }
             }
 
-            // empty task queue
+            // empty task queue (and work stealing deques, whose workers must have been stopped)
             void clear_queue() {
-                taskSignature* task;
+                TaskSlot* task;
                 while (mQueue.pop(task)) {
-                    delete task;
+                    TaskCache::release(task, nullptr);
+                }
+
+                for (auto& queue : mNodeQueues) {
+                    while (queue->pop(task)) {
+                        TaskCache::release(task, nullptr);
+                    }
+                }
+
+                for (auto& deque : mDeques) {
+                    while (deque->steal(task)) {
+                        TaskCache::release(task, nullptr);
+                    }
+                }
+
+                while (popOverflow(task)) {
+                    TaskCache::release(task, nullptr);
                 }
             }
 
             // pop wrapper around task
             taskSignature pop() {
-                taskSignature* task = nullptr;
-                mQueue.pop(task);
-                std::unique_ptr<taskSignature> func(task);
+                TaskSlot* task = nullptr;
                 taskSignature f;
-                if (task) {
-                    f = *task;
+                if (mQueue.pop(task) || popOverflow(task)) {
+                    f = std::move(task->mTask);
+                    TaskCache::release(task, nullptr);
                 }
                 return f;
             }
@@ -210,10 +702,7 @@ namespace BabyTask {
                 }
 
                 // stop all waiting threads
-                {
-                    std::unique_lock<std::mutex> lock(mMutex);
-                    mControlVariable.notify_all();
-                }
+                mEvent.notifyAll();
 
                 // wait for the computing threads to finish
                 for (std::size_t i{}; i < mThreads.size(); ++i) {  
@@ -230,6 +719,7 @@ namespace BabyTask {
 
             /**
             * \brief push a task to queue
+            *        (in work stealing policy, a task pushed by a pool worker goes to that worker deque)
             *
             * @param {F,       in}  task
             * @param {Args..., in}  task arguments
@@ -240,25 +730,44 @@ namespace BabyTask {
                 auto taskPack = std::make_shared<std::packaged_task<decltype(xi_task(0, xi_args...))(std::size_t)>>(
                                     std::bind(std::forward<F>(xi_task), std::placeholders::_1, std::forward<Args>(xi_args)...)
                                 );
-                auto task = new taskSignature([taskPack](std::size_t id) { (*taskPack)(id); });
-
-                mQueue.push(task);
-                std::unique_lock<std::mutex> lock(mMutex);
-                mControlVariable.notify_one();
-
+                enqueue(makeTask([taskPack](std::size_t id) { (*taskPack)(id); }));
                 return taskPack->get_future();
             }
 
             template<typename F>
             auto push(F&& xi_task) -> std::future<decltype(xi_task(0))> {
                 auto taskPack = std::make_shared<std::packaged_task<decltype(xi_task(0))(std::size_t)>>(std::forward<F>(xi_task));
-                auto task = new taskSignature([taskPack](std::size_t id) { (*taskPack)(id); });
+                enqueue(makeTask([taskPack](std::size_t id) { (*taskPack)(id); }));
+                return taskPack->get_future();
+            }
 
-                mQueue.push(task);
-                std::unique_lock<std::mutex> lock(mMutex);
-                mControlVariable.notify_one();
+            /**
+            * \brief push a task to queue without creating a future (fire and forget).
+            *        the task is held in a recycled slot, so a small task is pushed without any heap allocation.
+            *
+            * @param {F, in} task (callable as 'void(std::size_t id)')
+            **/
+            template<typename F>
+            void submit(F&& xi_task) {
+                enqueue(makeTask(std::forward<F>(xi_task)));
+            }
 
-                return taskPack->get_future();
+            /**
+            * \brief push a task which prefers to run on workers of a given NUMA node (fire and forget).
+            *        workers on other nodes only take it once they have nothing else to do.
+            *
+            * @param {F,      in} task (callable as 'void(std::size_t id)')
+            * @param {size_t, in} NUMA node (ignored if AnyNode, out of range or workers are not pinned)
+            **/
+            template<typename F>
+            void submit(F&& xi_task, std::size_t xi_node) {
+                enqueue(makeTask(std::forward<F>(xi_task)), xi_node);
             }
     };
+
+    // thread pool with a mutex protected unbounded queue
+    using ThreadPool = BasicThreadPool<Queue>;
+
+    // thread pool with a lock free bounded queue
+    using LockFreeThreadPool = BasicThreadPool<BoundedQueue>;
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace BabyTask {
+
+    // 'any NUMA node' locality hint
+    inline constexpr std::size_t AnyNode{ ~std::size_t{} };
+
+    /**
+    * \brief thread pool worker pinning policy
+    **/
+    enum class AffinityPolicy {
+        None,       // workers are not pinned (the OS migrates them freely)
+        Compact,    // workers fill the cpus of one NUMA node before moving to the next one
+        Scatter,    // workers are spread round robin across NUMA nodes
+        Explicit    // worker #i is pinned to the i'th cpu of a user supplied cpu set
+    };
+
+    /**
+    * \brief thread pool worker placement request
+    **/
+    struct Placement {
+        AffinityPolicy mPolicy{ AffinityPolicy::None };
+        std::vector<std::size_t> mCpus;     // cpu set (explicit policy only)
+    };
+
+    /**
+    * \brief where a given worker runs
+    **/
+    struct WorkerPlacement {
+        std::size_t mCpu{};         // cpu the worker is pinned to
+        std::size_t mNode{};        // NUMA node of that cpu
+        bool mPinned{ false };      // false if worker is not pinned
+    };
+
+    /**
+    * \brief return cpus the current process is allowed to run on
+    *
+    * @param {vector<size_t>, out} allowed cpus (ascending)
+    **/
+    inline std::vector<std::size_t> allowedCpus() {
+        std::vector<std::size_t> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (std::size_t i{}; i < CPU_SETSIZE; ++i) {
+                if (CPU_ISSET(i, &set)) {
+                    cpus.push_back(i);
+                }
+            }
+        }
+#endif
+        if (cpus.empty()) {
+            const std::size_t count{ std::max<std::size_t>(std::thread::hardware_concurrency(), 1) };
+            for (std::size_t i{}; i < count; ++i) {
+                cpus.push_back(i);
+            }
+        }
+        return cpus;
+    }
+
+    /**
+    * \brief pin the calling thread to a single cpu
+    *
+    * @param {size_t, in}  cpu
+    * @param {bool,   out} true if thread was pinned (always false on non Linux platforms)
+    **/
+    inline bool pinCurrentThread([[maybe_unused]] std::size_t xi_cpu) {
+#ifdef __linux__
+        if (xi_cpu >= CPU_SETSIZE) return false;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(xi_cpu, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+    * \brief cpus of every NUMA node.
+    *        nodes are numbered densely (in ascending sysfs id order), so a node index is a valid locality hint.
+    **/
+    class CpuTopology {
+
+        // properties
+        std::vector<std::vector<std::size_t>> mNodes;   // cpus of each NUMA node (ascending, never empty)
+
+        // API
+        public:
+
+            // default constructor (no nodes, nothing is pinned)
+            CpuTopology() = default;
+
+            /**
+            * \brief construct from the cpus of each node (empty nodes are dropped)
+            *
+            * @param {vector<vector<size_t>>, in} cpus of each node
+            **/
+            explicit CpuTopology(std::vector<std::vector<std::size_t>> xi_nodes) {
+                for (auto& cpus : xi_nodes) {
+                    if (!cpus.empty()) {
+                        std::sort(cpus.begin(), cpus.end());
+                        cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+                        mNodes.emplace_back(std::move(cpus));
+                    }
+                }
+            }
+
+            /**
+            * \brief parse a sysfs cpu list (i.e. - "0-3,8,10-11")
+            *
+            * @param {string_view,    in}  cpu list
+            * @param {vector<size_t>, out} cpus
+            **/
+            static std::vector<std::size_t> parseCpuList(std::string_view xi_list) {
+                std::vector<std::size_t> cpus;
+                std::size_t pos{};
+
+                auto number = [&xi_list, &pos](std::size_t& xo_value) {
+                    const std::size_t start{ pos };
+                    xo_value = 0;
+                    while ((pos < xi_list.size()) && (xi_list[pos] >= '0') && (xi_list[pos] <= '9')) {
+                        xo_value = xo_value * 10 + static_cast<std::size_t>(xi_list[pos] - '0');
+                        ++pos;
+                    }
+                    return pos > start;
+                };
+
+                while (pos < xi_list.size()) {
+                    std::size_t first{}, last{};
+                    if (!number(first)) {
+                        ++pos;
+                        continue;
+                    }
+
+                    last = first;
+                    if ((pos < xi_list.size()) && (xi_list[pos] == '-')) {
+                        ++pos;
+                        if (!number(last) || (last < first)) {
+                            last = first;
+                        }
+                    }
+
+                    for (std::size_t cpu{ first }; cpu <= last; ++cpu) {
+                        cpus.push_back(cpu);
+                    }
+                }
+
+                return cpus;
+            }
+
+            /**
+            * \brief read NUMA topology from sysfs ('<root>/nodeN/cpulist'), restricted to the cpus this process may use.
+            *        without sysfs NUMA information, all allowed cpus form a single node.
+            *
+            * @param {path,        in}  sysfs node directory
+            * @param {CpuTopology, out} topology
+            **/
+            static CpuTopology fromSysfs(const std::filesystem::path& xi_root = "/sys/devices/system/node") {
+                std::vector<std::size_t> allowed{ allowedCpus() };
+                std::vector<std::pair<std::size_t, std::vector<std::size_t>>> nodes;
+
+                std::error_code error;
+                for (std::filesystem::directory_iterator it(xi_root, error), end; !error && (it != end); it.increment(error)) {
+                    const std::string name{ it->path().filename().string() };
+                    if ((name.size() <= 4) || (name.compare(0, 4, "node") != 0) ||
+                        (name.find_first_not_of("0123456789", 4) != std::string::npos)) {
+                        continue;
+                    }
+
+                    std::ifstream file(it->path() / "cpulist");
+                    std::string list;
+                    if (!std::getline(file, list)) continue;
+
+                    std::vector<std::size_t> cpus;
+                    for (std::size_t cpu : parseCpuList(list)) {
+                        if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+                            cpus.push_back(cpu);
+                        }
+                    }
+                    nodes.emplace_back(std::stoul(name.substr(4)), std::move(cpus));
+                }
+
+                std::sort(nodes.begin(), nodes.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+                std::vector<std::vector<std::size_t>> cpus;
+                for (auto& node : nodes) {
+                    cpus.emplace_back(std::move(node.second));
+                }
+
+                CpuTopology topology(std::move(cpus));
+                if (topology.nodeCount() == 0) {
+                    topology = CpuTopology({ std::move(allowed) });
+                }
+                return topology;
+            }
+
+            // return topology of this machine (read once)
+            static const CpuTopology& system() {
+                static const CpuTopology topology{ fromSysfs() };
+                return topology;
+            }
+
+            // return amount of NUMA nodes
+            std::size_t nodeCount() const { return mNodes.size(); }
+
+            // return cpus of a given node
+            const std::vector<std::size_t>& cpus(std::size_t xi_node) const { return mNodes[xi_node]; }
+
+            // return total amount of cpus
+            std::size_t cpuCount() const {
+                std::size_t count{};
+                for (const auto& cpus : mNodes) {
+                    count += cpus.size();
+                }
+                return count;
+            }
+
+            /**
+            * \brief return NUMA node of a given cpu
+            *
+            * @param {size_t, in}  cpu
+            * @param {size_t, out} node (zero if cpu is unknown)
+            **/
+            std::size_t nodeOf(std::size_t xi_cpu) const {
+                for (std::size_t i{}; i < mNodes.size(); ++i) {
+                    if (std::binary_search(mNodes[i].begin(), mNodes[i].end(), xi_cpu)) {
+                        return i;
+                    }
+                }
+                return 0;
+            }
+
+            /**
+            * \brief return placement of a given worker (workers beyond the amount of cpus wrap around)
+            *
+            * @param {Placement,       in}  placement request
+            * @param {size_t,          in}  worker index
+            * @param {WorkerPlacement, out} worker placement
+            **/
+            WorkerPlacement place(const Placement& xi_placement, std::size_t xi_worker) const {
+                WorkerPlacement placement;
+                if (mNodes.empty()) return placement;
+
+                switch (xi_placement.mPolicy) {
+                    case AffinityPolicy::Compact: {
+                        std::size_t index{ xi_worker % cpuCount() };
+                        for (std::size_t i{}; i < mNodes.size(); ++i) {
+                            if (index < mNodes[i].size()) {
+                                placement = WorkerPlacement{ mNodes[i][index], i, true };
+                                break;
+                            }
+                            index -= mNodes[i].size();
+                        }
+                        break;
+                    }
+                    case AffinityPolicy::Scatter: {
+                        const std::size_t node{ xi_worker % mNodes.size() };
+                        const std::size_t index{ (xi_worker / mNodes.size()) % mNodes[node].size() };
+                        placement = WorkerPlacement{ mNodes[node][index], node, true };
+                        break;
+                    }
+                    case AffinityPolicy::Explicit: {
+                        if (!xi_placement.mCpus.empty()) {
+                            const std::size_t cpu{ xi_placement.mCpus[xi_worker % xi_placement.mCpus.size()] };
+                            placement = WorkerPlacement{ cpu, nodeOf(cpu), true };
+                        }
+                        break;
+                    }
+                    case AffinityPolicy::None:
+                        break;
+                }
+
+                return placement;
+            }
+    };
+};
@@ -0,0 +1,237 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#if defined(__x86_64__) || defined(_M_X64)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// node tracing is compiled in only when BABYTASK_TRACING is defined (otherwise trace statements vanish)
+#ifdef BABYTASK_TRACING
+#define BABYTASK_TRACE(statement) statement
+#else
+#define BABYTASK_TRACE(statement)
+#endif
+
+namespace BabyTask {
+
+    /**
+    * \brief a traced node execution
+    **/
+    struct TraceEvent {
+        std::string_view mName;     // node name (interned by tracer)
+        std::uint64_t mReady;       // when node became ready (ticks)
+        std::uint64_t mStart;       // when node started (ticks)
+        std::uint64_t mEnd;         // when node finished (ticks)
+        std::uint32_t mWorker;      // pool worker which finished the node
+    };
+
+    /**
+    * \brief collects trace events in per thread ring buffers (a thread only writes to its own buffer, so recording
+    *        is a timestamp read and a store) and exports them as Chrome trace JSON (chrome://tracing, Perfetto).
+    *        timestamps are time stamp counter ticks on x86-64 (steady clock nanoseconds elsewhere),
+    *        converted to microseconds on export. export (and clear) only when nothing is being recorded.
+    **/
+    class Tracer {
+
+        // amount of events held per thread (older events are overwritten)
+        static constexpr std::size_t Capacity = std::size_t{ 1 } << 14;
+
+        // a thread ring buffer
+        struct Buffer {
+            std::unique_ptr<TraceEvent[]> mEvents{ new TraceEvent[Capacity] };
+            std::atomic<std::size_t> mCount{};  // amount of events ever written
+        };
+
+        // properties
+        std::mutex mMutex;                                      // guards buffers list and names
+        std::vector<std::unique_ptr<Buffer>> mBuffers;          // buffers of all recording threads (outlive their threads)
+        std::unordered_set<std::string> mNames;                 // interned node names (outlive their graphs)
+        std::uint64_t mEpochTicks;                              // ticks when tracer was created
+        std::chrono::steady_clock::time_point mEpochTime;       // time when tracer was created
+
+        // constructor
+        Tracer() : mEpochTicks(now()), mEpochTime(std::chrono::steady_clock::now()) {}
+
+        // return current thread buffer
+        Buffer& local() {
+            static thread_local Buffer* buffer{ nullptr };
+            if (!buffer) {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mBuffers.emplace_back(std::make_unique<Buffer>());
+                buffer = mBuffers.back().get();
+            }
+            return *buffer;
+        }
+
+        // return amount of microseconds per tick
+        double microsecondsPerTick() const {
+            const std::uint64_t ticks{ now() - mEpochTicks };
+            const double microseconds{ std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - mEpochTime).count() };
+            return (ticks > 0) ? (microseconds / static_cast<double>(ticks)) : 0.0;
+        }
+
+        // API
+        public:
+
+            // copy semantics
+            Tracer(const Tracer&) = delete;
+            Tracer& operator=(const Tracer&) = delete;
+
+            // move semantics
+            Tracer(Tracer&&) noexcept = delete;
+            Tracer& operator=(Tracer&&) noexcept = delete;
+
+            // return tracer
+            static Tracer& instance() {
+                static Tracer tracer;
+                return tracer;
+            }
+
+            // return current timestamp (in ticks)
+            static std::uint64_t now() noexcept {
+#if defined(__x86_64__) || defined(_M_X64)
+                return __rdtsc();
+#else
+                return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+            }
+
+            /**
+            * \brief intern a name (interned names live as long as the tracer)
+            *
+            * @param {string_view, in}  name
+            * @param {string_view, out} interned name
+            **/
+            std::string_view intern(std::string_view xi_name) {
+                if (xi_name.empty()) {
+                    return {};
+                }
+
+                std::unique_lock<std::mutex> lock(mMutex);
+                return *mNames.emplace(xi_name).first;
+            }
+
+            /**
+            * \brief record an event in current thread ring buffer
+            *
+            * @param {TraceEvent, in} event
+            **/
+            void record(const TraceEvent& xi_event) {
+                Buffer& buffer = local();
+                const std::size_t count{ buffer.mCount.load(std::memory_order_relaxed) };
+                buffer.mEvents[count & (Capacity - 1)] = xi_event;
+                buffer.mCount.store(count + 1, std::memory_order_release);
+            }
+
+            /**
+            * \brief return all recorded events (the latest 'Capacity' events of every thread)
+            *
+            * @param {vector<TraceEvent>, out} events
+            **/
+            std::vector<TraceEvent> collect() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                std::vector<TraceEvent> events;
+                for (const auto& buffer : mBuffers) {
+                    const std::size_t count{ buffer->mCount.load(std::memory_order_acquire) };
+                    for (std::size_t i{ (count > Capacity) ? count - Capacity : 0 }; i < count; ++i) {
+                        events.push_back(buffer->mEvents[i & (Capacity - 1)]);
+                    }
+                }
+                return events;
+            }
+
+            // discard all recorded events
+            void clear() {
+                std::unique_lock<std::mutex> lock(mMutex);
+                for (auto& buffer : mBuffers) {
+                    buffer->mCount.store(0, std::memory_order_release);
+                }
+            }
+
+            /**
+            * \brief write recorded events as Chrome trace JSON: a complete ('X') event per node execution
+            *        (thread id is the pool worker id), with the time it became ready and its wait time as arguments
+            *
+            * @param {ostream, in} stream
+            **/
+            void writeChromeTrace(std::ostream& xo_stream) {
+                const std::vector<TraceEvent> events{ collect() };
+                const double scale{ microsecondsPerTick() };
+                auto microseconds = [this, scale](std::uint64_t ticks) { return static_cast<double>(static_cast<std::int64_t>(ticks - mEpochTicks)) * scale; };
+
+                char buffer[256];
+                xo_stream << "{\"traceEvents\":[";
+                for (std::size_t i{}; i < events.size(); ++i) {
+                    const TraceEvent& event = events[i];
+
+                    std::string name;
+                    for (char c : event.mName) {
+                        if ((c == '"') || (c == '\\')) name += '\\';
+                        if (static_cast<unsigned char>(c) >= 0x20) name += c;
+                    }
+
+                    const double ready{ microseconds(event.mReady) }, start{ microseconds(event.mStart) }, end{ microseconds(event.mEnd) };
+                    std::snprintf(buffer, sizeof(buffer), "\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"ready\":%.3f,\"wait\":%.3f}}",
+                                  event.mWorker, start, end - start, ready, start - ready);
+                    xo_stream << (i > 0 ? "," : "") << "\n{\"name\":\"" << (name.empty() ? std::string("node") : name) << "\"," << buffer;
+                }
+                xo_stream << "\n]}\n";
+            }
+
+            /**
+            * \brief write recorded events as Chrome trace JSON to a file
+            *
+            * @param {string, in}  file name
+            * @param {bool,   out} true if file was written
+            **/
+            bool exportChromeTrace(const std::string& xi_file) {
+                std::ofstream file(xi_file);
+                if (!file) {
+                    return false;
+                }
+
+                writeChromeTrace(file);
+                return static_cast<bool>(file);
+            }
+    };
+};
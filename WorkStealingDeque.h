@@ -0,0 +1,197 @@
+/**
+* BabyTask - minimalistic and generic graph based task library.
+*
+* The MIT License (MIT)
+*
+* Copyright (c) 2019 Dan Israel Malta
+*
+* Permission is hereby granted, free of charge, to any person obtaining a copy
+* of this software and associated documentation files (the "Software"), to deal
+* in the Software without restriction, including without limitation the rights
+* to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+* copies of the Software, and to permit persons to whom the Software is
+* furnished to do so, subject to the following conditions:
+*
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+*
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+* FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+* AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+* LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+* OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+* SOFTWARE.
+**/
+#pragma once
+
+#include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace BabyTask {
+
+    /**
+    * \brief lock free work stealing deque (Chase-Lev).
+    *        the owning thread pushes and pops at the bottom (LIFO),
+    *        any other thread may steal from the top (FIFO).
+    *
+    * @param {T} deque held element underlying type (must be trivially copyable, i.e. - a pointer)
+    **/
+    template<typename T> class WorkStealingDeque {
+        static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque element must be trivially copyable.");
+
+        /**
+        * \brief circular array of elements, its capacity is a power of two
+        **/
+        class Array {
+            std::int64_t mCapacity;
+            std::int64_t mMask;
+            std::unique_ptr<std::atomic<T>[]> mData;
+
+            public:
+
+                explicit Array(std::int64_t xi_capacity) : mCapacity(xi_capacity),
+                                                           mMask(xi_capacity - 1),
+                                                           mData(new std::atomic<T>[static_cast<std::size_t>(xi_capacity)]) {}
+
+                std::int64_t capacity() const noexcept { return mCapacity; }
+
+                void put(std::int64_t i, T xi_element) noexcept { mData[i & mMask].store(xi_element, std::memory_order_relaxed); }
+
+                T get(std::int64_t i) const noexcept { return mData[i & mMask].load(std::memory_order_relaxed); }
+
+                // return a copy of this array with twice its capacity
+                Array* grow(std::int64_t xi_bottom, std::int64_t xi_top) const {
+                    Array* larger = new Array(2 * mCapacity);
+                    for (std::int64_t i{ xi_top }; i != xi_bottom; ++i) {
+                        larger->put(i, get(i));
+                    }
+                    return larger;
+                }
+        };
+
+        // properties
+        alignas(64) std::atomic<std::int64_t> mTop;
+        alignas(64) std::atomic<std::int64_t> mBottom;
+        std::atomic<Array*> mArray;
+        std::vector<std::unique_ptr<Array>> mArrays;    // all arrays ever used (thieves might still read a replaced array)
+
+        // API
+        public:
+
+            // aliases
+            using value_type = T;
+            using size_type  = std::size_t;
+
+            // construct with an initial capacity (rounded up to a power of two)
+            explicit WorkStealingDeque(std::int64_t xi_capacity = 256) : mTop(0), mBottom(0) {
+                std::int64_t capacity{ 1 };
+                while (capacity < xi_capacity) capacity <<= 1;
+
+                mArrays.emplace_back(new Array(capacity));
+                mArray.store(mArrays.back().get(), std::memory_order_relaxed);
+            }
+
+            // copy semantics
+            WorkStealingDeque(const WorkStealingDeque&) = delete;
+            WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+            // move semantics
+            WorkStealingDeque(WorkStealingDeque&&) noexcept = delete;
+            WorkStealingDeque& operator=(WorkStealingDeque&&) noexcept = delete;
+
+            /**
+            * \brief push element to deque bottom (only the owner thread may call this)
+            *
+            * @param {T,    in}  element to push
+            * @param {bool, out} true if operation was successful
+            **/
+            bool push(T xi_element) {
+                const std::int64_t bottom{ mBottom.load(std::memory_order_relaxed) };
+                const std::int64_t top{ mTop.load(std::memory_order_acquire) };
+                Array* array{ mArray.load(std::memory_order_relaxed) };
+
+                // full, grow
+                if (bottom - top > array->capacity() - 1) {
+                    mArrays.emplace_back(array->grow(bottom, top));
+                    array = mArrays.back().get();
+                    mArray.store(array, std::memory_order_release);
+                }
+
+                array->put(bottom, xi_element);
+                mBottom.store(bottom + 1, std::memory_order_release);
+
+                return true;
+            }
+
+            /**
+            * \brief pop element from deque bottom (only the owner thread may call this)
+            *
+            * @param {T,    out} deque bottom element
+            * @param {bool, out} true if operation was successful
+            **/
+            bool pop(T& xo_element) {
+                const std::int64_t bottom{ mBottom.load(std::memory_order_relaxed) - 1 };
+                Array* array{ mArray.load(std::memory_order_relaxed) };
+                mBottom.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                std::int64_t top{ mTop.load(std::memory_order_relaxed) };
+
+                // deque is empty
+                if (top > bottom) {
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                xo_element = array->get(bottom);
+
+                // last element, race against thieves
+                if (top == bottom) {
+                    const bool won{ mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed) };
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                    return won;
+                }
+
+                return true;
+            }
+
+            /**
+            * \brief steal element from deque top (any thread may call this)
+            *
+            * @param {T,    out} deque top element
+            * @param {bool, out} true if operation was successful
+            **/
+            bool steal(T& xo_element) {
+                std::int64_t top{ mTop.load(std::memory_order_acquire) };
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const std::int64_t bottom{ mBottom.load(std::memory_order_acquire) };
+
+                if (top >= bottom) {
+                    return false;
+                }
+
+                Array* array{ mArray.load(std::memory_order_acquire) };
+                const T element{ array->get(top) };
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    return false;
+                }
+
+                xo_element = element;
+                return true;
+            }
+
+            /**
+            * \brief test if deque is empty (a snapshot, might be stale once returned)
+            *
+            * @param {bool, out} true if deque is empty
+            **/
+            bool empty() const noexcept {
+                const std::int64_t bottom{ mBottom.load(std::memory_order_relaxed) };
+                const std::int64_t top{ mTop.load(std::memory_order_relaxed) };
+                return bottom <= top;
+            }
+    };
+};
\ No newline at end of file